@@ -0,0 +1,29 @@
+#pragma once
+
+#include "GameConfig.h"
+
+namespace Eval { struct Weights; }
+
+// Batch analysis of EPD suites (--analyze-epd) and the search benchmark (--bench).
+//
+// Positions are shared out to a pool of OpenMP workers, each with its own
+// Botv3, engine and validator, and searched under the --depth / --nodes /
+// --movetime limits. Every position is written back as an EPD line with its
+// original operations plus the analysis:
+//   sm <move>; ce <score>; acd <depth>; acn <nodes>; acs <seconds>; pv <moves>;
+// (moves in SAN, ce from the side to move, mates beyond +-100000), streamed in
+// input order as soon as each line is finished. Positions with bm / am
+// operations count toward the solved rate printed at the end.
+namespace Analysis {
+
+// searchDepth: Botv3 depth limit (<= 0 keeps the bot default). Returns the
+// process exit code.
+int analyzeEpd(const GameConfig& config, int searchDepth, bool useNnue, const Eval::Weights* weights);
+
+// Fixed-depth search of about 40 embedded positions (--bench), single
+// threaded with the default evaluation and no book or tablebases. Prints the
+// node total, time and NPS: the total is a signature of search behaviour
+// (any change to what the search visits changes it) and NPS tracks speed.
+int bench(int depth, bool includeBotv2);
+
+}
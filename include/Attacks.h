@@ -0,0 +1,96 @@
+#pragma once
+
+#include "BitboardEngine.h"
+
+// Attack bitboards for every piece type, for evaluation terms that need to
+// know which squares a piece hits (mobility, king safety, threats) without
+// generating and validating moves. Tables are built at compile time, like the
+// Zobrist keys. Board layout as in BitboardEngine: index = row * 8 + col with
+// row 0 = rank 8, so white pawns attack toward lower indices.
+namespace Attacks {
+
+// Ray directions: N, S, E, W, NE, NW, SE, SW
+enum Direction { NORTH, SOUTH, EAST, WEST, NORTH_EAST, NORTH_WEST, SOUTH_EAST, SOUTH_WEST };
+static constexpr int DIR_ROW[8] = { -1, 1, 0,  0, -1, -1, 1,  1 };
+static constexpr int DIR_COL[8] = {  0, 0, 1, -1,  1, -1, 1, -1 };
+
+struct Tables {
+    Bitboard knight[64];
+    Bitboard king[64];
+    Bitboard pawn[2][64];     // [color][square]
+    Bitboard rays[8][64];     // [direction][square], origin excluded
+};
+
+constexpr Bitboard stepMask(int row, int col, const int (*steps)[2], int count) {
+    Bitboard b = 0;
+    for (int i = 0; i < count; i++) {
+        int r = row + steps[i][0], c = col + steps[i][1];
+        if (r >= 0 && r < 8 && c >= 0 && c < 8) b |= 1ULL << (r * 8 + c);
+    }
+    return b;
+}
+
+constexpr Tables generateTables() {
+    Tables t{};
+    constexpr int knightSteps[8][2] = { {-2,-1}, {-2,1}, {-1,-2}, {-1,2}, {1,-2}, {1,2}, {2,-1}, {2,1} };
+    constexpr int kingSteps[8][2]   = { {-1,-1}, {-1,0}, {-1,1}, {0,-1}, {0,1}, {1,-1}, {1,0}, {1,1} };
+    constexpr int whitePawn[2][2]   = { {-1,-1}, {-1,1} };
+    constexpr int blackPawn[2][2]   = { {1,-1}, {1,1} };
+    for (int sq = 0; sq < 64; sq++) {
+        int row = sq / 8, col = sq % 8;
+        t.knight[sq]  = stepMask(row, col, knightSteps, 8);
+        t.king[sq]    = stepMask(row, col, kingSteps, 8);
+        t.pawn[0][sq] = stepMask(row, col, whitePawn, 2);
+        t.pawn[1][sq] = stepMask(row, col, blackPawn, 2);
+        for (int d = 0; d < 8; d++) {
+            int r = row + DIR_ROW[d], c = col + DIR_COL[d];
+            while (r >= 0 && r < 8 && c >= 0 && c < 8) {
+                t.rays[d][sq] |= 1ULL << (r * 8 + c);
+                r += DIR_ROW[d];
+                c += DIR_COL[d];
+            }
+        }
+    }
+    return t;
+}
+
+inline constexpr Tables TABLES = generateTables();
+
+inline Bitboard knightAttacks(int sq) { return TABLES.knight[sq]; }
+inline Bitboard kingAttacks(int sq)   { return TABLES.king[sq]; }
+inline Bitboard pawnAttacks(int color, int sq) { return TABLES.pawn[color][sq]; }
+
+// All squares attacked by a set of pawns at once
+inline Bitboard pawnAttacksSet(Bitboard pawns, int color) {
+    constexpr Bitboard FILE_A = 0x0101010101010101ULL;
+    constexpr Bitboard FILE_H = FILE_A << 7;
+    if (color == 0) return ((pawns & ~FILE_A) >> 9) | ((pawns & ~FILE_H) >> 7);
+    return ((pawns & ~FILE_H) << 9) | ((pawns & ~FILE_A) << 7);
+}
+
+// Ray from sq in direction d, cut off after the first occupied square.
+// Directions that increase the index find the blocker with ctz, the others with clz.
+inline Bitboard rayAttacks(int d, int sq, Bitboard occupied) {
+    Bitboard ray = TABLES.rays[d][sq];
+    Bitboard blockers = ray & occupied;
+    if (!blockers) return ray;
+    bool increasing = (d == SOUTH || d == EAST || d == SOUTH_EAST || d == SOUTH_WEST);
+    int blocker = increasing ? __builtin_ctzll(blockers) : 63 - __builtin_clzll(blockers);
+    return ray ^ TABLES.rays[d][blocker];
+}
+
+inline Bitboard rookAttacks(int sq, Bitboard occupied) {
+    return rayAttacks(NORTH, sq, occupied) | rayAttacks(SOUTH, sq, occupied) |
+           rayAttacks(EAST, sq, occupied)  | rayAttacks(WEST, sq, occupied);
+}
+
+inline Bitboard bishopAttacks(int sq, Bitboard occupied) {
+    return rayAttacks(NORTH_EAST, sq, occupied) | rayAttacks(NORTH_WEST, sq, occupied) |
+           rayAttacks(SOUTH_EAST, sq, occupied) | rayAttacks(SOUTH_WEST, sq, occupied);
+}
+
+inline Bitboard queenAttacks(int sq, Bitboard occupied) {
+    return rookAttacks(sq, occupied) | bishopAttacks(sq, occupied);
+}
+
+}
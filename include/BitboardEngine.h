@@ -1,11 +1,14 @@
 #pragma once
 
+#include "Nnue.h"
 #include <cstdint>
 #include <string>
 
 // Bitboard type for representing piece positions
 using Bitboard = uint64_t;
 
+namespace Eval { struct Weights; }
+
 class BitboardEngine {
 public:
     BitboardEngine();
@@ -24,6 +27,28 @@ public:
     Bitboard allBlackPieces;
     Bitboard allPieces;
     
+    // Zobrist hash of the piece placement, updated incrementally by
+    // setPieceAt / clearSquare / movePiece (side, castling and en passant
+    // are folded in by MoveValidator::getPositionKey)
+    uint64_t zobristKey;
+    
+    // Zobrist hash of the pawns alone (keys the evaluation's pawn hash table)
+    uint64_t pawnKey;
+    
+    // Piece counts, 4 bits per piece constant (keys the evaluation's material
+    // hash; see Endgame.h)
+    uint64_t materialKey;
+    
+    // Incremental evaluation state (maintained alongside zobristKey):
+    // material + PST from white's perspective (packed mg/eg Eval::Score)
+    int32_t psqt;
+    
+    // NNUE first-layer accumulator, only maintained while a network is loaded.
+    // Mutable because Nnue::evaluate rebuilds stale perspectives on demand.
+    // Not part of EngineState (it is large): setState marks it stale, and a
+    // search evaluating with NNUE saves and restores it itself.
+    mutable Nnue::Accumulator nnueAcc;
+    
     // Initialize to starting position
     void initializeStartingPosition();
     
@@ -57,6 +82,61 @@ public:
     // Update combined bitboards after manual bitboard changes
     void updateCombinedBitboards();
     
+    // Recompute the Zobrist key from scratch (after manual bitboard changes)
+    uint64_t computeZobristKey() const;
+    
+    // Evaluation weights behind psqt and Eval::evaluate (defaults to
+    // Eval::DEFAULT_WEIGHTS; nullptr restores it). Changing them rebuilds the
+    // incremental state. The pointed-to weights must outlive the engine's use of them.
+    void setWeights(const Eval::Weights* w);
+    const Eval::Weights& getWeights() const { return *weights; }
+    
+    // Rebuild zobristKey, pawnKey, materialKey and psqt from the bitboards
+    // (the NNUE accumulator is marked stale and rebuilt on its next use)
+    // (after setting up a position by writing bitboards directly)
+    void refreshIncrementalState();
+    
+    // FEN piece placement field ("rnbqkbnr/pppppppp/8/..."), read up to the
+    // first space so a whole FEN can be passed. Returns false, leaving the
+    // position unchanged, if the field is malformed or a side doesn't have
+    // exactly one king.
+    bool loadPlacement(const std::string& fen);
+    std::string placementFen() const;
+    
+    // State save/restore for bot search
+    struct EngineState {
+        Bitboard pawns[2], rooks[2], knights[2], bishops[2], queens[2], kings[2];
+        Bitboard allWhitePieces, allBlackPieces, allPieces;
+        uint64_t zobristKey, pawnKey, materialKey;
+        int32_t psqt;
+    };
+    
+    EngineState getState() const {
+        return {{pawns[0], pawns[1]}, {rooks[0], rooks[1]}, {knights[0], knights[1]},
+                {bishops[0], bishops[1]}, {queens[0], queens[1]}, {kings[0], kings[1]},
+                allWhitePieces, allBlackPieces, allPieces, zobristKey, pawnKey,
+                materialKey, psqt};
+    }
+    
+    void setState(const EngineState& s) {
+        for (int i = 0; i < 2; i++) {
+            pawns[i]   = s.pawns[i];
+            rooks[i]   = s.rooks[i];
+            knights[i] = s.knights[i];
+            bishops[i] = s.bishops[i];
+            queens[i]  = s.queens[i];
+            kings[i]   = s.kings[i];
+        }
+        allWhitePieces = s.allWhitePieces;
+        allBlackPieces = s.allBlackPieces;
+        allPieces      = s.allPieces;
+        zobristKey     = s.zobristKey;
+        pawnKey        = s.pawnKey;
+        materialKey    = s.materialKey;
+        psqt           = s.psqt;
+        nnueAcc.dirty[0] = nnueAcc.dirty[1] = true;
+    }
+    
     // Piece type constants (public for use by bots and validators)
     static const int WHITE_PAWN = 0;
     static const int BLACK_PAWN = 1;
@@ -71,4 +151,12 @@ public:
     static const int WHITE_KING = 10;
     static const int BLACK_KING = 11;
     static const int EMPTY = -1;
+
+private:
+    const Eval::Weights* weights;
+    
+    // Keep zobristKey and the evaluation accumulators in step with a piece
+    // appearing on / disappearing from a square
+    void onPieceAdded(int piece, int index);
+    void onPieceRemoved(int piece, int index);
 };
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "BitboardEngine.h"
+#include "MoveValidator.h"
+#include <cstdint>
+#include <random>
+#include <string>
+
+// Polyglot opening book (.bin), memory-mapped and searched in place.
+//
+// A book is a sequence of 16-byte big-endian entries sorted by key:
+//   uint64 key, uint16 move, uint16 weight, uint32 learn
+// The key is the Polyglot hash of the position (its own fixed random table,
+// unrelated to Zobrist.h). A move packs to-file, to-rank, from-file, from-rank
+// (3 bits each, rank 0 = rank 1) and the promotion piece (1 = knight ..
+// 4 = queen); castling is written as the king taking its own rook (e1h1).
+namespace Book {
+
+struct Entry {
+    uint64_t key;
+    uint16_t move;
+    uint16_t weight;
+    uint32_t learn;
+};
+
+// Polyglot key of the position with sideToMove to move
+uint64_t key(const BitboardEngine& eng, const MoveValidator& validator, int sideToMove);
+
+// Map a book file, replacing any loaded before; false (with a message) on failure
+bool load(const std::string& path);
+void unload();
+bool isLoaded();
+
+// Entries stored for key, at most maxEntries, in file order; returns how many
+int probe(uint64_t key, Entry* out, int maxEntries);
+
+// Move for key chosen at random in proportion to the entries' weights;
+// false when the book has no entry (of non-zero weight) for it
+bool pick(uint64_t key, std::mt19937& rng, uint16_t& move);
+
+// Book move in engine terms: castling becomes the king's two-square move and
+// the promotion a piece constant for color (-1 if none). The result still has
+// to be matched against the legal moves.
+Move decodeMove(uint16_t move, const BitboardEngine& eng, int color);
+
+// Polyglot encoding of a legal move, taken before it is made on eng
+uint16_t encodeMove(const Move& move, const BitboardEngine& eng);
+
+}
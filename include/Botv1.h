@@ -49,7 +49,7 @@ public:
             // For each root move, execute it, then call alphaBeta for opponent's reply
             for (auto& rootMove : rootMoves) {
                 // Save full state before making the move
-                EngineState engState = saveEngineState(*eng);
+                BitboardEngine::EngineState engState = eng->getState();
                 MoveValidator::ValidatorState valState = validator.getState();
 
                 // Execute move
@@ -60,7 +60,7 @@ public:
                 int eval = alphaBeta(validator, *eng, depth - 1, 1 - color, alpha, beta);
 
                 // Restore state
-                restoreEngineState(*eng, engState);
+                eng->setState(engState);
                 validator.setState(valState);
 
                 // White maximizes, black minimizes
@@ -117,6 +117,8 @@ public:
 
     std::string getName() const override { return "Botv1"; }
 
+    void setSeed(uint32_t seed) override { rng.seed(seed); }
+
 private:
     mutable std::mt19937 rng;
     int maxDepth = MAX_DEPTH;
@@ -149,7 +151,7 @@ private:
             // maximize
             int maxEval = INT_MIN;
             for (auto& move : moves) {
-                EngineState engState = saveEngineState(eng);
+                BitboardEngine::EngineState engState = eng.getState();
                 MoveValidator::ValidatorState valState = validator.getState();
 
                 Move m = move;
@@ -157,7 +159,7 @@ private:
 
                 int eval = alphaBeta(validator, eng, depth - 1, 1, alpha, beta);
 
-                restoreEngineState(eng, engState);
+                eng.setState(engState);
                 validator.setState(valState);
 
                 if (eval > maxEval) maxEval = eval;
@@ -169,7 +171,7 @@ private:
             // minimize
             int minEval = INT_MAX;
             for (auto& move : moves) {
-                EngineState engState = saveEngineState(eng);
+                BitboardEngine::EngineState engState = eng.getState();
                 MoveValidator::ValidatorState valState = validator.getState();
 
                 Move m = move;
@@ -177,7 +179,7 @@ private:
 
                 int eval = alphaBeta(validator, eng, depth - 1, 0, alpha, beta);
 
-                restoreEngineState(eng, engState);
+                eng.setState(engState);
                 validator.setState(valState);
 
                 if (eval < minEval) minEval = eval;
@@ -289,42 +291,4 @@ private:
         }
         return allMoves;
     }
-
-    // holds all bitboards
-    struct EngineState {
-        Bitboard pawns[2], rooks[2], knights[2], bishops[2], queens[2], kings[2];
-        Bitboard allWhitePieces, allBlackPieces, allPieces;
-    };
-
-    // returns a snapshot of the entire engine state
-    static EngineState saveEngineState(const BitboardEngine& eng) {
-        EngineState s;
-        for (int i = 0; i < 2; i++) {
-            s.pawns[i]   = eng.pawns[i];
-            s.rooks[i]   = eng.rooks[i];
-            s.knights[i] = eng.knights[i];
-            s.bishops[i] = eng.bishops[i];
-            s.queens[i]  = eng.queens[i];
-            s.kings[i]   = eng.kings[i];
-        }
-        s.allWhitePieces = eng.allWhitePieces;
-        s.allBlackPieces = eng.allBlackPieces;
-        s.allPieces      = eng.allPieces;
-        return s;
-    }
-
-    // restores a previously saved engine state
-    static void restoreEngineState(BitboardEngine& eng, const EngineState& s) {
-        for (int i = 0; i < 2; i++) {
-            eng.pawns[i]   = s.pawns[i];
-            eng.rooks[i]   = s.rooks[i];
-            eng.knights[i] = s.knights[i];
-            eng.bishops[i] = s.bishops[i];
-            eng.queens[i]  = s.queens[i];
-            eng.kings[i]   = s.kings[i];
-        }
-        eng.allWhitePieces = s.allWhitePieces;
-        eng.allBlackPieces = s.allBlackPieces;
-        eng.allPieces      = s.allPieces;
-    }
 };
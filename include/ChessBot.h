@@ -3,6 +3,7 @@
 #include "BitboardEngine.h"
 #include "MoveValidator.h"
 #include <string>
+#include <cstdint>
 
 class ChessBot {
 public:
@@ -19,4 +20,31 @@ public:
 
     // Optional: set search depth (no-op by default for bots without depth)
     virtual void setMaxDepth(int /*depth*/) {}
+
+    // Called before the first move of every game so bots can drop knowledge
+    // carried over from the previous game (no-op for stateless bots)
+    virtual void newGame() {}
+
+    // Optional: stop searching after this many nodes (0 = no limit). Node
+    // limits keep games reproducible where wall-clock limits would not.
+    // A node is any position the search visits, horizon and quiescence
+    // positions included, so the same limit is the same budget for every bot.
+    virtual void setNodeLimit(int64_t /*nodes*/) {}
+
+    // Optional: stop deepening once a search has run this many milliseconds
+    // (0 = no limit). Unlike node limits, results depend on machine speed.
+    virtual void setTimeLimit(int64_t /*ms*/) {}
+
+    // Optional: nodes searched by the last chooseMove (0 for bots that don't count)
+    virtual int64_t getNodes() const { return 0; }
+
+    // Optional: reseed the bot's tie-break / move-choice randomness
+    virtual void setSeed(uint32_t /*seed*/) {}
+
+    // Optional: evaluate with the loaded NNUE network instead of PeSTO
+    virtual void setUseNnue(bool /*enabled*/) {}
+
+    // Optional: evaluate with these weights instead of Eval::DEFAULT_WEIGHTS
+    // (nullptr = defaults). The bot keeps the pointer, so the weights must outlive it.
+    virtual void setEvalWeights(const Eval::Weights* /*weights*/) {}
 };
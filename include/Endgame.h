@@ -0,0 +1,47 @@
+#pragma once
+
+#include "BitboardEngine.h"
+#include <cstdint>
+
+// Specialised endgame knowledge, selected by material signature.
+//
+// BitboardEngine::materialKey packs the count of every piece constant into
+// 4 bits (WHITE_PAWN in bits 0-3 ... BLACK_KING in bits 44-47), so a material
+// signature like "KRK" maps to exactly one key per strong side. The material
+// hash in Evaluation.h looks each key up here once and caches the result.
+//
+// Evaluation functions replace Eval::evaluate outright (mating nets, dead
+// draws); scaling functions only shrink the endgame half of the normal score
+// when the side ahead is unlikely to convert (opposite-coloured bishops).
+namespace Endgame {
+
+// Scores for won endings stay well clear of the search's mate scores (100000)
+constexpr int KNOWN_WIN = 10000;
+
+// Endgame scale factors: the eg score is multiplied by factor / SCALE_NORMAL
+constexpr int SCALE_NORMAL = 64;
+constexpr int SCALE_NONE   = -1;  // scaling function has no opinion
+
+constexpr uint64_t materialUnit(int piece) { return 1ULL << (4 * piece); }
+constexpr int pieceCount(uint64_t materialKey, int piece) { return static_cast<int>((materialKey >> (4 * piece)) & 15); }
+
+// White-relative score for the position; strong is the side with the extra material
+using EvalFn = int (*)(const BitboardEngine& eng, int strong);
+// Scale factor (0..SCALE_NORMAL) for strong's advantage, or SCALE_NONE
+using ScaleFn = int (*)(const BitboardEngine& eng, int strong);
+
+struct Entry {
+    EvalFn evaluate;  // nullptr: use the normal evaluation
+    ScaleFn scale;    // nullptr: no special scaling
+    int strong;       // side evaluate() is called for (scale() gets whichever side is ahead)
+};
+
+// Specialised evaluator / scaler for a material key, or nullptr
+const Entry* probe(uint64_t materialKey);
+
+// King + pawn vs king from the bitbase (Kpk.h), which needs the side to move
+// that Eval::evaluate doesn't have: false unless eng is KPK, otherwise score
+// is the exact result from sideToMove's point of view (0 = draw)
+bool probeKpk(const BitboardEngine& eng, int sideToMove, int& score);
+
+}
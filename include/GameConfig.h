@@ -2,6 +2,8 @@
 
 #include <string>
 #include <iostream>
+#include <cstdint>
+#include <cctype>
 
 // Game mode
 enum class GameMode {
@@ -21,6 +23,23 @@ struct GameConfig {
     int depth = -1;            // -1 = use bot default, otherwise override MAX_DEPTH
     int testBotGames = 0;      // 0 = normal play, >0 = run N games in test-bots mode
     bool silent = false;       // Suppress all cout output
+    int multiPV = 1;           // Number of ranked root lines Botv3 reports (analysis)
+    int64_t nodes = 0;         // 0 = no node limit, otherwise bots stop searching after N nodes
+    bool seedSpecified = false; // true when --seed was given (reproducible games)
+    uint32_t seed = 0;         // Base seed for bot tie-breaks and test-bots color draws
+    std::string nnueFile;      // Network for Botv3's NNUE evaluation (empty = PeSTO)
+    std::string weightsFileA;  // Eval weights for bot A / bot B (empty = compiled-in defaults)
+    std::string weightsFileB;
+    std::string bookFile;      // Polyglot opening book Botv3 plays from (empty = none)
+    std::string tablebaseDir;  // Directory of tbgen tables Botv3 probes (empty = none)
+    int64_t moveTimeMs = 0;    // 0 = no time limit, otherwise bots stop deepening after this many ms
+    int threads = 0;           // Worker threads for test-bots / analysis (0 = all cores)
+    std::string analyzeEpdFile; // EPD suite to analyze instead of playing (empty = play)
+    std::string analyzeOutFile; // Where analysis results go (empty = standard output)
+    int benchDepth = 0;        // > 0 = run the search benchmark at this depth instead of playing
+    bool benchBotv2 = false;   // Bench Botv2 as well as Botv3
+
+    static constexpr int DEFAULT_BENCH_DEPTH = 5;
 
     static void printUsage(const char* programName) {
         std::cout << "Usage: " << programName << " --mode <mode> [options]\n"
@@ -39,6 +58,23 @@ struct GameConfig {
                   << "  --depth <n>              Override bot search depth (default: bot's MAX_DEPTH)\n"
                   << "  --test-bots <n>          Run n games between the two bots (bvb mode)\n"
                   << "  --silent                 Suppress all game output (auto-enabled for test-bots)\n"
+                  << "  --multipv <k>            Botv3 ranks its top k root moves (shown with --debug)\n"
+                  << "  --nodes <n>              Limit each bot search to n nodes (deepens until the budget runs out\n"
+                  << "                             unless --depth is also given)\n"
+                  << "  --seed <s>               Seed all bot randomness; with --nodes or --depth games are reproducible\n"
+                  << "  --nnue <file>            Load an NNUE network and let Botv3 evaluate with it\n"
+                  << "  --weights <file>         Eval weights for bot A (text block from tune, or binary)\n"
+                  << "  --weights-b <file>       Eval weights for bot B, e.g. for A/B runs with --test-bots\n"
+                  << "  --book <file>            Play the opening from a Polyglot book (.bin)\n"
+                  << "  --tb <dir>               Load the endgame tablebases in dir (written by tbgen)\n"
+                  << "  --movetime <ms>          Limit each bot search to ms milliseconds (not reproducible)\n"
+                  << "  --threads <n>            Worker threads for --test-bots and --analyze-epd (default: all cores)\n"
+                  << "  --analyze-epd <file>     Search every position of an EPD file with Botv3 (no --mode needed);\n"
+                  << "                             limits from --depth / --nodes / --movetime, bm/am scored\n"
+                  << "  --analyze-out <file>     Write --analyze-epd results to file (default: standard output)\n"
+                  << "  --bench [depth]          Search the built-in bench positions (default depth 5) and print\n"
+                  << "                             total nodes (a search signature), time and NPS (no --mode needed)\n"
+                  << "  --bench-botv2            Include Botv2 in --bench\n"
                   << "\nExamples:\n"
                   << "  " << programName << " --mode pvp                # Human vs Human with GUI\n"
                   << "  " << programName << " --mode pvb                # Play white vs random bot\n"
@@ -47,6 +83,9 @@ struct GameConfig {
                   << "  " << programName << " --mode bvb --gui          # Bot vs Bot with GUI\n"
                   << "  " << programName << " --mode bvb --depth 5       # Bot vs Bot, depth 5\n"
                   << "  " << programName << " --mode bvb --test-bots 10  # 10 games, randomized colors\n"
+                  << "  " << programName << " --mode bvb --test-bots 10 --nodes 20000 --seed 1  # reproducible run\n"
+                  << "  " << programName << " --analyze-epd wac.epd --movetime 1000 --analyze-out wac.out\n"
+                  << "  " << programName << " --bench                   # node signature + NPS before merging\n"
                   << std::endl;
     }
 
@@ -108,6 +147,107 @@ struct GameConfig {
                     return false;
                 }
             }
+            else if (arg == "--multipv") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --multipv requires a positive integer\n";
+                    return false;
+                }
+                config.multiPV = std::stoi(argv[++i]);
+                if (config.multiPV < 1) {
+                    std::cerr << "Error: --multipv must be >= 1\n";
+                    return false;
+                }
+            }
+            else if (arg == "--nodes") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --nodes requires a positive integer\n";
+                    return false;
+                }
+                config.nodes = std::stoll(argv[++i]);
+                if (config.nodes < 1) {
+                    std::cerr << "Error: --nodes must be >= 1\n";
+                    return false;
+                }
+            }
+            else if (arg == "--seed") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --seed requires an integer\n";
+                    return false;
+                }
+                config.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+                config.seedSpecified = true;
+            }
+            else if (arg == "--nnue") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --nnue requires a network file\n";
+                    return false;
+                }
+                config.nnueFile = argv[++i];
+            }
+            else if (arg == "--weights" || arg == "--weights-b") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: " << arg << " requires a weights file\n";
+                    return false;
+                }
+                (arg == "--weights" ? config.weightsFileA : config.weightsFileB) = argv[++i];
+            }
+            else if (arg == "--book") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --book requires a book file\n";
+                    return false;
+                }
+                config.bookFile = argv[++i];
+            }
+            else if (arg == "--tb") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --tb requires a directory\n";
+                    return false;
+                }
+                config.tablebaseDir = argv[++i];
+            }
+            else if (arg == "--movetime") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --movetime requires a positive integer\n";
+                    return false;
+                }
+                config.moveTimeMs = std::stoll(argv[++i]);
+                if (config.moveTimeMs < 1) {
+                    std::cerr << "Error: --movetime must be >= 1\n";
+                    return false;
+                }
+            }
+            else if (arg == "--threads") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --threads requires a positive integer\n";
+                    return false;
+                }
+                config.threads = std::stoi(argv[++i]);
+                if (config.threads < 1) {
+                    std::cerr << "Error: --threads must be >= 1\n";
+                    return false;
+                }
+            }
+            else if (arg == "--analyze-epd" || arg == "--analyze-out") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: " << arg << " requires a file\n";
+                    return false;
+                }
+                (arg == "--analyze-epd" ? config.analyzeEpdFile : config.analyzeOutFile) = argv[++i];
+            }
+            else if (arg == "--bench") {
+                // Optional depth: only taken when the next argument is a number
+                config.benchDepth = DEFAULT_BENCH_DEPTH;
+                if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                    config.benchDepth = std::stoi(argv[++i]);
+                    if (config.benchDepth < 1) {
+                        std::cerr << "Error: --bench depth must be >= 1\n";
+                        return false;
+                    }
+                }
+            }
+            else if (arg == "--bench-botv2") {
+                config.benchBotv2 = true;
+            }
             else if (arg == "--silent") {
                 config.silent = true;
             }
@@ -130,8 +270,8 @@ struct GameConfig {
             }
         }
 
-        // Require explicit --mode argument
-        if (!config.modeSpecified) {
+        // Require explicit --mode argument (analysis and bench don't play a game)
+        if (!config.modeSpecified && config.analyzeEpdFile.empty() && config.benchDepth == 0) {
             std::cerr << "Error: --mode is required\n\n";
             printUsage(argv[0]);
             return false;
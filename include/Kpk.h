@@ -0,0 +1,12 @@
+#pragma once
+
+// King + pawn vs king bitbase: win/draw for every legal KPK position, built
+// by retrograde analysis on first use (a few milliseconds) and kept as one bit
+// per position (24 KB; pawn files e-h are mirrored onto a-d).
+namespace Kpk {
+
+// True if the side with the pawn wins. Squares are BitboardEngine indices
+// (row 0 = rank 8); strongSide is the pawn's colour, sideToMove who is to move.
+bool probe(int strongKing, int pawn, int weakKing, int strongSide, int sideToMove);
+
+}
@@ -17,6 +17,21 @@ struct Move {
         : fromRow(fr), fromCol(fc), toRow(tr), toCol(tc), 
           capturedPiece(-1), isEnPassant(false), isPawnPromotion(false), promotedTo(-1),
           isCastling(false) {}
+    Move() : Move(0, 0, 0, 0) {}
+};
+
+// The FEN fields kept outside the engine and validator: side to move and the
+// clocks (the game or search tracks these itself)
+struct FenState {
+    int sideToMove = 0;      // 0 = white, 1 = black
+    int halfmoveClock = 0;   // plies since the last capture or pawn move
+    int fullmoveNumber = 1;  // starts at 1, incremented after black's move
+};
+
+// One EPD operation, e.g. bm Nf3 Qd2; or id "WAC.001"; (quotes removed)
+struct EpdOperation {
+    std::string opcode;
+    std::vector<std::string> operands;
 };
 
 class MoveValidator {
@@ -30,6 +45,11 @@ public:
     // Get all valid moves for a piece
     std::vector<Move> getValidMoves(int row, int col, int playerColor);
     
+    // Same, written into a caller-owned buffer (at least MAX_PIECE_MOVES long).
+    // Returns the number of moves; never allocates (used by bot search).
+    static const int MAX_PIECE_MOVES = 28;
+    int getValidMoves(int row, int col, int playerColor, Move* out);
+    
     // Execute a move (updates bitboard and handles captures/en passant)
     // Populates move flags (isEnPassant, isPawnPromotion, capturedPiece)
     // If isValidated is true, we bypass the heavy isValidMove() check (useful for bot generated moves)
@@ -84,6 +104,36 @@ public:
         blackQueensideCastle = s.blackQueensideCastle;
     }
 
+    // Coordinate notation for logs and PV output (e.g. "e2e4", "e7e8q")
+    static std::string moveToString(const Move& move);
+
+    // Standard algebraic notation of a legal move for playerColor, taken
+    // before it is made (e.g. "Nbd7", "exd6", "e8=Q+", "O-O#")
+    std::string moveToSan(const Move& move, int playerColor);
+
+    // The legal move for playerColor written in SAN or coordinate notation;
+    // false if there is none or the text is ambiguous. A promotion without a
+    // piece is to a queen.
+    bool parseMove(const std::string& text, int playerColor, Move& out);
+
+    // Full position hash: piece placement + side to move + castling rights + en passant file
+    uint64_t getPositionKey(int sideToMove) const;
+
+    // Set up the engine and validator from a FEN. The clocks may be missing
+    // (defaults are used). Castling rights whose king or rook isn't on its
+    // home square are dropped. Returns false, changing nothing, on a
+    // malformed FEN.
+    bool loadFen(const std::string& fen, FenState& state);
+    std::string toFen(const FenState& state) const;
+
+    // EPD: the first four FEN fields followed by operations (appended to
+    // operations when given). The hmvc and fmvn operations set the clocks.
+    bool loadEpd(const std::string& epd, FenState& state, std::vector<EpdOperation>* operations = nullptr);
+    std::string toEpd(int sideToMove, const std::vector<EpdOperation>& operations = {}) const;
+
+    // Parse the operations part of an EPD line; false on unbalanced quotes
+    static bool parseEpdOperations(const std::string& text, std::vector<EpdOperation>& operations);
+
     // Non-const access to engine (for bot search make/unmake)
     BitboardEngine* getEngine() { return engine; }
 
@@ -104,6 +154,11 @@ private:
     bool isCastlingMove(int fromRow, int fromCol, int toRow, int toCol, int playerColor);
     void updateCastlingRights(int piece, int fromRow, int fromCol);
     
+    // Shared by loadFen / loadEpd: the placement, side, castling and en
+    // passant fields; nothing is changed unless all four are valid
+    bool setPosition(const std::string& placement, const std::string& side,
+                     const std::string& castling, const std::string& enPassant, int& sideToMove);
+    
     // Piece constants for easier use
     static const int WHITE = 0;
     static const int BLACK = 1;
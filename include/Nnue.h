@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class BitboardEngine;
+
+// Optional efficiently-updatable neural network evaluation (CPU only).
+//
+// Features are HalfKP-like: for each perspective (white, black), the
+// perspective's king square x every non-king piece (5 types x 2 owners) x
+// square, mirrored vertically for black so both sides see the board "from
+// their own side". The first layer is a 256-wide int16 accumulator per
+// perspective that BitboardEngine updates as pieces appear and disappear; a
+// king move only marks its perspective dirty and the next evaluation rebuilds
+// it. The rest of the network is small and evaluated per call:
+//
+//   [white acc | black acc] (512, clipped ReLU 0..127)
+//     -> 32 (int8 weights, >> 6, clipped ReLU) -> 32 (same) -> 1 (/ OUTPUT_SCALE)
+//
+// Unlike the usual side-to-move formulation the input order is always
+// white first and the output is white-relative centipawns, matching
+// Eval::evaluate (the engine does not know whose turn it is).
+//
+// Network file (little endian), memory-mapped and used in place:
+//   64-byte header: "CBNN", uint32 version, uint32 inputs, l1, l2, l3, then zero padding
+//   int16 ftBias[L1], int16 ftWeights[INPUTS][L1]
+//   int32 h1Bias[L2], int8 h1Weights[L2][2*L1]
+//   int32 h2Bias[L3], int8 h2Weights[L3][L2]
+//   int32 outBias,    int8 outWeights[L3]
+namespace Nnue {
+
+constexpr int PIECE_KINDS  = 10;                    // pawn..queen, own / enemy
+constexpr int INPUTS       = 64 * PIECE_KINDS * 64; // king square x kind x square
+constexpr int L1           = 256;
+constexpr int L2           = 32;
+constexpr int L3           = 32;
+constexpr int HIDDEN_SHIFT = 6;
+constexpr int OUTPUT_SCALE = 16;
+constexpr uint32_t FILE_VERSION = 1;
+
+// First-layer output for both perspectives. Lives in BitboardEngine and is
+// updated incrementally as pieces move; it is not part of EngineState, so a
+// search that evaluates with it copies it into its own per-ply restore points.
+struct Accumulator {
+    alignas(32) int16_t values[2][L1];
+    bool dirty[2] = { true, true };   // perspective needs a full rebuild
+    uint32_t generation = 0;          // network this was built for (see load())
+};
+
+// Map a network file. Replaces any network already loaded; every accumulator
+// built for the old one is rebuilt on its next evaluation.
+bool load(const std::string& path);
+void unload();
+bool isLoaded();
+
+// Which SIMD path this build uses ("avx2", "sse4.1" or "scalar")
+const char* simdName();
+
+// Accumulator maintenance, called from BitboardEngine's piece hooks before
+// the bitboards change
+void pieceAdded(Accumulator& acc, const BitboardEngine& eng, int piece, int index);
+void pieceRemoved(Accumulator& acc, const BitboardEngine& eng, int piece, int index);
+
+// White-relative score in centipawns. Rebuilds dirty perspectives first.
+// Requires isLoaded().
+int evaluate(const BitboardEngine& eng);
+
+}
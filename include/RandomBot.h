@@ -48,6 +48,8 @@ public:
 
     std::string getName() const override { return "RandomBot"; }
 
+    void setSeed(uint32_t seed) override { rng.seed(seed); }
+
 private:
     std::mt19937 rng;
 };
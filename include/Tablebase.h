@@ -0,0 +1,85 @@
+#pragma once
+
+#include "BitboardEngine.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Endgame tablebases generated locally by tools/tbgen (no external downloads).
+//
+// One file per material signature, e.g. "KQKR.tb" (white's pieces, then
+// black's), holding one distance-to-mate byte for every position index, from
+// the side to move's point of view. Files are memory-mapped and read in place.
+//
+// Index: [side to move][white king][other pieces' squares, 64 each], with the
+// board symmetries folded in: pawnless tables put the white king in the
+// a1-d1-d4 triangle (10 squares), tables with pawns mirror it onto files a-d
+// (32 squares). Castling, en passant and the fifty-move rule are not modelled.
+//
+// File (little endian): 64-byte header: "CBTB", uint32 version, uint64 material
+// key, uint64 entry count, char name[16], then zero padding; one byte per entry.
+namespace Tablebase {
+
+constexpr int MAX_PIECES = 4;
+constexpr uint32_t FILE_VERSION = 1;
+
+// Entry values. Wins take an odd number of plies, losses an even number
+// (0 = checkmated); distances fit in 0..125.
+constexpr uint8_t DRAW    = 0;
+constexpr uint8_t UNKNOWN = 254;  // generator only
+constexpr uint8_t ILLEGAL = 255;
+constexpr int MAX_DISTANCE = 125;
+
+constexpr uint8_t winIn(int plies)  { return static_cast<uint8_t>(plies); }
+constexpr uint8_t lossIn(int plies) { return static_cast<uint8_t>(128 + plies); }
+constexpr bool isWin(uint8_t v)  { return v >= 1 && v < 128; }
+constexpr bool isLoss(uint8_t v) { return v >= 128 && v < UNKNOWN; }
+constexpr int distance(uint8_t v) { return v < 128 ? v : v - 128; }
+
+// Search score for a value probed ply plies from the search root: wins rank
+// above Endgame::KNOWN_WIN and below the search's mate scores, sooner wins
+// (and later losses) scoring better. Like mate scores, the distance counts
+// from the root, so a win found deeper in the tree ranks below a shorter one.
+constexpr int TB_WIN = 50000;
+constexpr int TB_BOUND = TB_WIN - 256;  // every score is at least this far from 0 (distance + ply < 256)
+constexpr int score(uint8_t v, int ply = 0) {
+    return isWin(v) ? TB_WIN - ply - distance(v) : isLoss(v) ? -(TB_WIN - ply - distance(v)) : 0;
+}
+
+struct PieceSquare {
+    int piece;   // BitboardEngine piece constant
+    int square;  // BitboardEngine index
+};
+
+// Piece slots and index space of one signature
+struct Layout {
+    std::string name;          // "KQKR"
+    int count = 0;
+    int pieces[MAX_PIECES];    // slot order: white king, black king, white's other pieces, black's
+    bool hasPawns = false;
+    uint64_t materialKey = 0;  // BitboardEngine::materialKey of the position as named
+    uint64_t size = 0;         // entries, both sides to move
+};
+
+// Layout for a name like "KQKR" (pieces among K Q R B N P); false if malformed
+bool parseLayout(const std::string& name, Layout& out);
+// Canonical name for a material key ("K" + white's pieces + "K" + black's, in QRBNP order)
+std::string nameOf(uint64_t materialKey);
+// The same material with the colours swapped
+uint64_t flipMaterialKey(uint64_t materialKey);
+
+// Index of a position whose material matches the layout (any piece order)
+uint64_t encode(const Layout& layout, const PieceSquare* pieces, int sideToMove);
+// Square per slot and side to move of an index (its symmetry-normalised form)
+void decode(const Layout& layout, uint64_t index, int* squares, int& sideToMove);
+
+bool save(const std::string& path, const Layout& layout, const std::vector<uint8_t>& values);
+
+// Map every *.tb file in dir, replacing tables loaded before; returns how many loaded
+int init(const std::string& dir);
+// Most pieces (kings included) any loaded table covers; 0 when none are loaded
+int maxPieces();
+// Value for eng with sideToMove to move; false when no loaded table covers it
+bool probe(const BitboardEngine& eng, int sideToMove, uint8_t& value);
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "MoveValidator.h"
+#include "Tablebase.h"
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+
+// Fixed-size transposition table keyed by MoveValidator::getPositionKey.
+// Each bot owns one and keeps it alive between chooseMove calls so later
+// searches start warm. Entries carry the search generation that wrote them:
+// entries from older searches are still probed and reused, but are the first
+// to be replaced when a slot is contested. newGame() wipes the table.
+//
+// Mate and tablebase scores count plies from the root, so the same mate
+// found through different paths (or in a later search) would read
+// differently. Entries store them relative to their own node instead:
+// store() and probe() take the node's ply and convert.
+class TranspositionTable {
+public:
+    static constexpr int MATE_BOUND = 100000;  // scores at least this far from 0 are mates
+
+    enum Bound : uint8_t { BOUND_NONE = 0, BOUND_UPPER = 1, BOUND_LOWER = 2, BOUND_EXACT = 3 };
+
+    struct Entry {
+        uint64_t key;
+        int32_t  score;
+        uint16_t move;        // packed with packMove(), 0 = none
+        int8_t   depth;
+        uint8_t  genBound;    // generation in the high 6 bits, Bound in the low 2
+
+        Bound bound() const { return static_cast<Bound>(genBound & 3); }
+        uint8_t generation() const { return genBound >> 2; }
+    };
+
+    explicit TranspositionTable(size_t megabytes = 16) { resize(megabytes); }
+
+    void resize(size_t megabytes) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Entry) <= megabytes * 1024 * 1024) count *= 2;
+        table.assign(count, Entry{});
+        mask = count - 1;
+        generation = 0;
+    }
+
+    // Wipe everything (new game: nothing learned so far applies)
+    void clear() {
+        std::fill(table.begin(), table.end(), Entry{});
+        generation = 0;
+    }
+
+    // Start a new search: entries written from now on are "fresh"
+    void newSearch() { generation = (generation + 1) & 63; }
+
+    // Returns true and fills out on a key match. A hit refreshes the entry's
+    // generation so positions that keep recurring survive replacement.
+    bool probe(uint64_t key, int ply, Entry& out) {
+        Entry& e = table[key & mask];
+        if (e.key != key || e.bound() == BOUND_NONE) return false;
+        e.genBound = static_cast<uint8_t>((generation << 2) | e.bound());
+        out = e;
+        out.score = fromNodeScore(e.score, ply);
+        return true;
+    }
+
+    // Replacement: same position, empty slot, stale generation, or deeper search
+    void store(uint64_t key, int depth, int ply, int score, Bound bound, uint16_t move) {
+        Entry& e = table[key & mask];
+        bool samePosition = (e.key == key);
+        if (!samePosition && e.bound() != BOUND_NONE &&
+            e.generation() == generation && depth < e.depth) {
+            return;
+        }
+        // Keep the old best move if this search didn't produce one
+        if (move == 0 && samePosition) move = e.move;
+        e.key = key;
+        e.score = toNodeScore(score, ply);
+        e.move = move;
+        e.depth = static_cast<int8_t>(depth);
+        e.genBound = static_cast<uint8_t>((generation << 2) | bound);
+    }
+
+    // Occupancy of the first 1000 slots written by the current search, in permille
+    int hashfull() const {
+        int used = 0;
+        size_t n = std::min<size_t>(1000, table.size());
+        for (size_t i = 0; i < n; i++) {
+            if (table[i].bound() != BOUND_NONE && table[i].generation() == generation) used++;
+        }
+        return static_cast<int>(used * 1000 / n);
+    }
+
+    // Move packing: from square (6 bits), to square (6 bits), promotion piece + 1 (4 bits)
+    static uint16_t packMove(const Move& m) {
+        int from = m.fromRow * 8 + m.fromCol;
+        int to   = m.toRow * 8 + m.toCol;
+        int promo = (m.promotedTo == -1) ? 0 : m.promotedTo + 1;
+        return static_cast<uint16_t>(from | (to << 6) | (promo << 12));
+    }
+
+    static bool matches(const Move& m, uint16_t packed) {
+        return packed != 0 && packMove(m) == packed;
+    }
+
+private:
+    // Root-relative score at ply <-> score relative to that node. Mates (beyond
+    // MATE_BOUND) and tablebase results (beyond Tablebase::TB_BOUND) both shift.
+    static int toNodeScore(int score, int ply) {
+        if (score >= Tablebase::TB_BOUND) return score + ply;
+        if (score <= -Tablebase::TB_BOUND) return score - ply;
+        return score;
+    }
+    static int fromNodeScore(int score, int ply) {
+        if (score >= Tablebase::TB_BOUND) return score - ply;
+        if (score <= -Tablebase::TB_BOUND) return score + ply;
+        return score;
+    }
+
+    std::vector<Entry> table;
+    size_t mask = 0;
+    uint8_t generation = 0;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+// Zobrist hashing keys for position identification (transposition table, repetition).
+// Keys are generated at compile time with splitmix64 so every build and every
+// machine produces identical hashes.
+namespace Zobrist {
+
+struct Keys {
+    uint64_t pieces[12][64];   // [piece constant][square index]
+    uint64_t side;             // XORed in when black is to move
+    uint64_t castling[4];      // white K, white Q, black K, black Q
+    uint64_t enPassant[8];     // file of the en passant target square
+};
+
+constexpr uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr Keys generateKeys() {
+    Keys k{};
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (int p = 0; p < 12; p++) {
+        for (int sq = 0; sq < 64; sq++) {
+            k.pieces[p][sq] = splitmix64(state);
+        }
+    }
+    k.side = splitmix64(state);
+    for (int i = 0; i < 4; i++) k.castling[i] = splitmix64(state);
+    for (int i = 0; i < 8; i++) k.enPassant[i] = splitmix64(state);
+    return k;
+}
+
+inline constexpr Keys KEYS = generateKeys();
+
+inline uint64_t pieceKey(int piece, int index) { return KEYS.pieces[piece][index]; }
+
+}
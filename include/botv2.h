@@ -20,8 +20,15 @@ public:
     void setMaxDepth(int depth) override { maxDepth = depth; }
     int getMaxDepth() const { return maxDepth; }
 
+    void setNodeLimit(int64_t limit) override { nodeLimit = limit; }
+    void setTimeLimit(int64_t ms) override { timeLimitMs = ms; }
+    int64_t getNodes() const override { return nodes; }
+    void setSeed(uint32_t seed) override { rng.seed(seed); }
+    void setEvalWeights(const Eval::Weights* weights) override { evalWeights = weights; }
+
     Move chooseMove(const BitboardEngine&, MoveValidator& validator, int color) override {
         BitboardEngine* eng = validator.getEngine();
+        eng->setWeights(evalWeights);
 
         // Generate all legal moves at the root
         std::vector<Move> rootMoves = generateAllMoves(*eng, validator, color);
@@ -32,11 +39,15 @@ public:
         // Stats per depth level
         struct DepthStats { int positions; long long timeMs; int eval; };
         std::vector<DepthStats> stats;
+        nodes = 0;
+        stopped = false;
+        searchStart = std::chrono::steady_clock::now();
 
         // Iterative deepening with alpha-beta pruning
         for (int depth = 1; depth <= maxDepth; depth++) {
             auto start = std::chrono::high_resolution_clock::now(); // Start timer
             positionsEvaluated = 0;
+            rootDepth = depth;
 
             // Order root moves: previous best first, then by MVV-LVA score
             orderMoves(rootMoves, *eng, bestMove);
@@ -50,7 +61,7 @@ public:
             // For each root move, execute it, then call alphaBeta for opponent's reply
             for (auto& rootMove : rootMoves) {
                 // Save full state before making the move
-                EngineState engState = saveEngineState(*eng);
+                BitboardEngine::EngineState engState = eng->getState();
                 MoveValidator::ValidatorState valState = validator.getState();
 
                 // Execute move
@@ -61,9 +72,11 @@ public:
                 int eval = alphaBeta(validator, *eng, depth - 1, 1 - color, alpha, beta);
 
                 // Restore state
-                restoreEngineState(*eng, engState);
+                eng->setState(engState);
                 validator.setState(valState);
 
+                if (stopped) break;  // node or time budget ran out mid-iteration
+
                 // White maximizes, black minimizes
                 if (color == 0) {
                     if (eval > bestEval) {
@@ -84,6 +97,9 @@ public:
                 }
             }
 
+            // An interrupted iteration is incomplete: keep the previous depth's move
+            if (stopped) break;
+
             // Randomly pick among tied best moves for variety
             if (tiedMoves.size() > 1) {
                 std::uniform_int_distribution<size_t> dist(0, tiedMoves.size() - 1);
@@ -122,9 +138,35 @@ private:
     mutable std::mt19937 rng;
     int maxDepth = MAX_DEPTH;
     int positionsEvaluated = 0;
+    const Eval::Weights* evalWeights = nullptr;  // nullptr = Eval::DEFAULT_WEIGHTS
+
+    // Node- or time-limited search: depth 1 always completes so there is a move to play
+    int64_t nodeLimit = 0;
+    int64_t timeLimitMs = 0;
+    int64_t nodes = 0;
+    int rootDepth = 0;
+    bool stopped = false;
+    std::chrono::steady_clock::time_point searchStart;
+
+    // Counts the node; the clock is only read every 1024 nodes. Botv2 has no
+    // quiescence search, so its horizon leaves (counted here too) are the
+    // positions Botv3 would count in quiescence.
+    bool outOfBudget() {
+        ++nodes;
+        if (rootDepth > 1 && !stopped) {
+            if (nodeLimit > 0 && nodes > nodeLimit) stopped = true;
+            if (timeLimitMs > 0 && (nodes & 1023) == 0
+                && std::chrono::steady_clock::now() - searchStart >= std::chrono::milliseconds(timeLimitMs)) {
+                stopped = true;
+            }
+        }
+        return stopped;
+    }
 
     int alphaBeta(MoveValidator& validator, BitboardEngine& eng, int depth, int currentColor, int alpha, int beta) {
-        // At horizon, drop into quiescence search to resolve captures
+        if (outOfBudget()) return 0;
+
+        // At horizon: static evaluation (Botv2 has no quiescence search)
         if (depth == 0) {
             positionsEvaluated++;
             return evaluate(eng);
@@ -150,7 +192,7 @@ private:
             // maximize
             int maxEval = INT_MIN;
             for (auto& move : moves) {
-                EngineState engState = saveEngineState(eng);
+                BitboardEngine::EngineState engState = eng.getState();
                 MoveValidator::ValidatorState valState = validator.getState();
 
                 Move m = move;
@@ -158,8 +200,9 @@ private:
 
                 int eval = alphaBeta(validator, eng, depth - 1, 1, alpha, beta);
 
-                restoreEngineState(eng, engState);
+                eng.setState(engState);
                 validator.setState(valState);
+                if (stopped) return 0;
 
                 if (eval > maxEval) maxEval = eval;
                 if (eval > alpha) alpha = eval;
@@ -170,7 +213,7 @@ private:
             // minimize
             int minEval = INT_MAX;
             for (auto& move : moves) {
-                EngineState engState = saveEngineState(eng);
+                BitboardEngine::EngineState engState = eng.getState();
                 MoveValidator::ValidatorState valState = validator.getState();
 
                 Move m = move;
@@ -178,8 +221,9 @@ private:
 
                 int eval = alphaBeta(validator, eng, depth - 1, 0, alpha, beta);
 
-                restoreEngineState(eng, engState);
+                eng.setState(engState);
                 validator.setState(valState);
+                if (stopped) return 0;
 
                 if (eval < minEval) minEval = eval;
                 if (eval < beta) beta = eval;
@@ -279,42 +323,4 @@ private:
         }
         return allMoves;
     }
-
-    // holds all bitboards
-    struct EngineState {
-        Bitboard pawns[2], rooks[2], knights[2], bishops[2], queens[2], kings[2];
-        Bitboard allWhitePieces, allBlackPieces, allPieces;
-    };
-
-    // returns a snapshot of the entire engine state
-    static EngineState saveEngineState(const BitboardEngine& eng) {
-        EngineState s;
-        for (int i = 0; i < 2; i++) {
-            s.pawns[i]   = eng.pawns[i];
-            s.rooks[i]   = eng.rooks[i];
-            s.knights[i] = eng.knights[i];
-            s.bishops[i] = eng.bishops[i];
-            s.queens[i]  = eng.queens[i];
-            s.kings[i]   = eng.kings[i];
-        }
-        s.allWhitePieces = eng.allWhitePieces;
-        s.allBlackPieces = eng.allBlackPieces;
-        s.allPieces      = eng.allPieces;
-        return s;
-    }
-
-    // restores a previously saved engine state
-    static void restoreEngineState(BitboardEngine& eng, const EngineState& s) {
-        for (int i = 0; i < 2; i++) {
-            eng.pawns[i]   = s.pawns[i];
-            eng.rooks[i]   = s.rooks[i];
-            eng.knights[i] = s.knights[i];
-            eng.bishops[i] = s.bishops[i];
-            eng.queens[i]  = s.queens[i];
-            eng.kings[i]   = s.kings[i];
-        }
-        eng.allWhitePieces = s.allWhitePieces;
-        eng.allBlackPieces = s.allBlackPieces;
-        eng.allPieces      = s.allPieces;
-    }
 };
\ No newline at end of file
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "ChessBot.h"
+#include "Book.h"
 #include "Evaluation.h"
 #include "Game.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
 #include <vector>
 #include <string>
 #include <iostream>
@@ -15,72 +18,161 @@ class Botv3 : public ChessBot {
 public:
     static constexpr int MAX_DEPTH = 5;
     static constexpr int MAX_QDEPTH = 4;
+    static constexpr int TT_SIZE_MB = 16;
+    static constexpr int MAX_PLY = 64;  // negamax plies + quiescence plies
+    static constexpr int MAX_MOVES = 256; // upper bound on legal moves in a position
+    // Being mated at ply p scores -(MATE_SCORE - p): sooner mates are worse,
+    // and every mate stays beyond TranspositionTable::MATE_BOUND
+    static constexpr int MATE_SCORE = TranspositionTable::MATE_BOUND + MAX_PLY;
 
-    Botv3() : rng(std::random_device{}()) {}
+    Botv3() : rng(std::random_device{}()), tt(TT_SIZE_MB), stack(MAX_PLY) {}
 
-    void setMaxDepth(int depth) override { maxDepth = depth; }
+    void setMaxDepth(int depth) override { maxDepth = std::min(depth, MAX_PLY - MAX_QDEPTH - 1); }
     int getMaxDepth() const { return maxDepth; }
 
+    // One ranked root line for multi-PV analysis
+    struct PvLine {
+        Move move;
+        int score;
+        std::vector<Move> pv;  // starts with move
+    };
+
+    // Number of best root moves to rank each iteration (1 = normal play).
+    // Line k is searched with lines 1..k-1 excluded; all passes share the TT.
+    void setMultiPV(int lines) { multiPV = std::max(1, lines); }
+    int getMultiPV() const { return multiPV; }
+
+    // Ranked lines from the last completed iteration
+    const std::vector<PvLine>& getMultiPVResults() const { return pvLines; }
+
+    // Nodes searched by the last chooseMove and the deepest iteration it
+    // completed (0 when the move came from the book or a tablebase)
+    int64_t getNodes() const override { return nodes; }
+    int getCompletedDepth() const { return completedDepth; }
+
+    // Principal variation from the last completed iteration (root move first)
+    std::vector<Move> getPrincipalVariation() const {
+        return pvLines.empty() ? std::vector<Move>() : pvLines[0].pv;
+    }
+
+    void setNodeLimit(int64_t limit) override { nodeLimit = limit; }
+    void setTimeLimit(int64_t ms) override { timeLimitMs = ms; }
+    void setSeed(uint32_t seed) override { rng.seed(seed); }
+
+    // Cached scores came from the other evaluator, so drop them on a switch
+    void setUseNnue(bool enabled) override {
+        if (enabled != useNnue) evalCache = Eval::EvalCache();
+        useNnue = enabled;
+    }
+
+    void setEvalWeights(const Eval::Weights* weights) override {
+        if (weights != evalWeights) evalCache = Eval::EvalCache();
+        evalWeights = weights;
+    }
+
+    // Entries survive between moves (aged by generation); a new game starts cold.
+    // The eval cache goes too: a warm hit returns an exact score where a miss
+    // might stop at a lazy bound, so leftovers from earlier games would make
+    // a seeded game's search depend on what its thread played before.
+    void newGame() override {
+        tt.clear();
+        evalCache = Eval::EvalCache();
+    }
+
     Move chooseMove(const BitboardEngine&, MoveValidator& validator, int color) override {
         BitboardEngine* eng = validator.getEngine();
+        eng->setWeights(evalWeights);  // the opponent may have searched with other weights
+        nnueSearch = useNnue && Nnue::isLoaded();
+        if (nnueSearch) Nnue::evaluate(*eng);  // rebuild a stale accumulator once, not at every node
 
+        pvLines.clear();
+        nodes = 0;
+        completedDepth = 0;
         std::vector<Move> rootMoves = generateAllMoves(*eng, validator, color);
         if (rootMoves.empty()) return Move(0, 0, 0, 0);
 
+        // In the opening book or covered by a tablebase: no search needed
+        Move bookMove;
+        if (probeBook(validator, *eng, rootMoves, color, bookMove)) return bookMove;
+        Move tbMove;
+        if (tablebaseMove(validator, *eng, rootMoves, color, tbMove)) return tbMove;
+
         Move bestMove = rootMoves[0];
+        tt.newSearch();
+        for (SearchStack& ss : stack) ss.killers[0] = ss.killers[1] = Move();
+        stopped = false;
+        searchStart = std::chrono::steady_clock::now();
 
-        struct DepthStats { int positions; long long timeMs; int eval; };
+        struct DepthStats { int depth; int positions; long long timeMs; int eval; int ttHits;
+                            uint64_t evalHits, evalMisses, lazyEvals; std::string pv; };
         std::vector<DepthStats> stats;
+        Eval::PawnHashTable& pawnHash = Eval::pawnTable();
+        uint64_t pawnProbesStart = pawnHash.probes, pawnHitsStart = pawnHash.hits;
 
         for (int depth = 1; depth <= maxDepth; depth++) {
             auto start = std::chrono::high_resolution_clock::now();
             positionsEvaluated = 0;
+            ttHits = 0;
+            evalCache.hits = evalCache.misses = 0;
+            lazyEvals = 0;
+            rootDepth = depth;
 
             orderMoves(rootMoves, *eng, bestMove);
 
-            int alpha = -100000000;
-            int beta  =  100000000;
-            int bestEval = -100000000;
-            Move depthBest = rootMoves[0];
-
-            for (auto& rootMove : rootMoves) {
-                EngineState engState = saveEngineState(*eng);
-                MoveValidator::ValidatorState valState = validator.getState();
-
-                Move m = rootMove;
-                if (!validator.executeMove(m, color, true)) {
-                    restoreEngineState(*eng, engState);
-                    validator.setState(valState);
-                    continue;
+            std::vector<PvLine> depthLines;
+            int linesWanted = std::min(multiPV, (int)rootMoves.size());
+            for (int lineIdx = 0; lineIdx < linesWanted; lineIdx++) {
+                // Walk the previous iteration's line of the same rank first
+                rootPvLength = 0;
+                if (lineIdx < (int)pvLines.size()) {
+                    for (const Move& m : pvLines[lineIdx].pv) rootPv[rootPvLength++] = m;
                 }
 
-                int eval = -negamax(validator, *eng, depth - 1, 1 - color, -beta, -alpha);
+                PvLine line;
+                if (!searchRoot(validator, *eng, rootMoves, color, depth, depthLines, line)) break;
+                depthLines.push_back(line);
+            }
 
-                restoreEngineState(*eng, engState);
-                validator.setState(valState);
+            // An interrupted iteration is incomplete: keep the previous depth's lines
+            if (stopped) break;
 
-                if (eval > bestEval) {
-                    bestEval = eval;
-                    depthBest = rootMove;
-                }
+            if (!depthLines.empty()) {
+                pvLines = depthLines;
+                bestMove = pvLines[0].move;
+                completedDepth = depth;
 
-                if (eval > alpha) alpha = eval;
+                auto end = std::chrono::high_resolution_clock::now();
+                long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+                stats.push_back({depth, positionsEvaluated, ms, pvLines[0].score, ttHits,
+                                 evalCache.hits, evalCache.misses, lazyEvals, pvToString(pvLines[0].pv)});
             }
-
-            bestMove = depthBest;
-
-            auto end = std::chrono::high_resolution_clock::now();
-            long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-            stats.push_back({positionsEvaluated, ms, bestEval});
         }
 
         if (g_debugOutput) {
             std::cout << "\n=== Botv3 Search ===" << std::endl;
             for (int i = 0; i < (int)stats.size(); i++) {
-                std::cout << "  Depth " << (i + 1)
+                std::cout << "  Depth " << stats[i].depth
                           << ": " << stats[i].positions << " positions"
                           << ", " << stats[i].timeMs << "ms"
-                          << ", eval=" << stats[i].eval << std::endl;
+                          << ", eval=" << stats[i].eval
+                          << ", tt hits=" << stats[i].ttHits
+                          << ", eval cache " << stats[i].evalHits << "/"
+                          << (stats[i].evalHits + stats[i].evalMisses) << " hits"
+                          << ", lazy evals=" << stats[i].lazyEvals
+                          << ", pv " << stats[i].pv << std::endl;
+            }
+            if (pvLines.size() > 1) {
+                for (int i = 0; i < (int)pvLines.size(); i++) {
+                    std::cout << "  MultiPV " << (i + 1)
+                              << ": eval=" << pvLines[i].score
+                              << ", pv " << pvToString(pvLines[i].pv) << std::endl;
+                }
+            }
+            std::cout << "  TT: " << tt.hashfull() / 10.0 << "% full" << std::endl;
+            uint64_t pawnProbes = pawnHash.probes - pawnProbesStart;
+            if (pawnProbes > 0) {
+                std::cout << "  Pawn hash: " << (pawnHash.hits - pawnHitsStart) * 100 / pawnProbes
+                          << "% hits (" << pawnProbes << " probes)" << std::endl;
             }
             std::cout << "  Best: "
                       << BitboardEngine::squareToAlgebraic(bestMove.fromRow, bestMove.fromCol)
@@ -97,7 +189,173 @@ public:
 private:
     mutable std::mt19937 rng;
     int maxDepth = MAX_DEPTH;
+    int multiPV = 1;
+    std::vector<PvLine> pvLines;
     int positionsEvaluated = 0;
+    int ttHits = 0;
+    TranspositionTable tt;
+    Eval::EvalCache evalCache;
+    uint64_t lazyEvals = 0;  // stand-pat evaluations cut short by Eval::evaluateLazy
+    bool useNnue = false;
+    const Eval::Weights* evalWeights = nullptr;  // nullptr = Eval::DEFAULT_WEIGHTS
+
+    // Node- or time-limited search: depth 1 always completes so there is a move to play
+    int64_t nodeLimit = 0;
+    int64_t timeLimitMs = 0;
+    int64_t nodes = 0;
+    int rootDepth = 0;
+    int completedDepth = 0;
+    bool stopped = false;
+    std::chrono::steady_clock::time_point searchStart;
+
+    // Counts the node; the clock is only read every 1024 nodes
+    bool outOfBudget() {
+        ++nodes;
+        if (rootDepth > 1 && !stopped) {
+            if (nodeLimit > 0 && nodes > nodeLimit) stopped = true;
+            if (timeLimitMs > 0 && (nodes & 1023) == 0
+                && std::chrono::steady_clock::now() - searchStart >= std::chrono::milliseconds(timeLimitMs)) {
+                stopped = true;
+            }
+        }
+        return stopped;
+    }
+
+    // Per-ply search state, preallocated once per bot so a node touches only
+    // reserved memory: no heap traffic inside negamax/quiescence.
+    struct SearchStack {
+        Move moves[MAX_MOVES];               // this ply's generated move list
+        int moveCount = 0;
+        int staticEval = 0;                  // stand-pat score (quiescence nodes)
+        Move killers[2];                     // quiet moves that caused beta cutoffs here
+        Move currentMove;                    // move being searched from this ply
+        Move pv[MAX_PLY];                    // triangular PV row: pv[ply..pvLength)
+        int pvLength = 0;
+        BitboardEngine::EngineState engState;        // restore points for make/unmake
+        MoveValidator::ValidatorState valState;
+        Nnue::Accumulator nnueAcc;                   // only saved while searching with NNUE
+    };
+    std::vector<SearchStack> stack;
+
+    // useNnue with a network loaded, fixed for the current search
+    bool nnueSearch = false;
+
+    // Make/unmake restore points. The accumulator is large, so it is copied
+    // only when the search evaluates with it; otherwise setState just marks
+    // it stale.
+    void saveState(SearchStack& ss, const BitboardEngine& eng, const MoveValidator& validator) {
+        ss.engState = eng.getState();
+        ss.valState = validator.getState();
+        if (nnueSearch) ss.nnueAcc = eng.nnueAcc;
+    }
+
+    void restoreState(const SearchStack& ss, BitboardEngine& eng, MoveValidator& validator) {
+        eng.setState(ss.engState);
+        validator.setState(ss.valState);
+        if (nnueSearch) eng.nnueAcc = ss.nnueAcc;
+    }
+
+    Move rootPv[MAX_PLY];   // line being followed this pass (previous iteration's result)
+    int rootPvLength = 0;
+    bool followPv = false;  // true while the current path matches rootPv
+
+    // Full-window search over the root moves not already taken by a higher-ranked
+    // line. Returns false when no move is left to search.
+    bool searchRoot(MoveValidator& validator, BitboardEngine& eng, const std::vector<Move>& rootMoves,
+                    int color, int depth, const std::vector<PvLine>& excluded, PvLine& out) {
+        SearchStack& ss = stack[0];
+        int alpha = NEG_INF;
+        int beta  = POS_INF;
+        bool found = false;
+
+        for (auto& rootMove : rootMoves) {
+            bool taken = std::any_of(excluded.begin(), excluded.end(),
+                                     [&](const PvLine& l) { return sameMove(l.move, rootMove); });
+            if (taken) continue;
+
+            saveState(ss, eng, validator);
+
+            ss.currentMove = rootMove;
+            if (!validator.executeMove(ss.currentMove, color, true)) {
+                restoreState(ss, eng, validator);
+                continue;
+            }
+
+            followPv = rootPvLength > 1 && sameMove(rootMove, rootPv[0]);
+            int eval = -negamax(validator, eng, depth - 1, 1 - color, -beta, -alpha, 1);
+            followPv = false;
+
+            restoreState(ss, eng, validator);
+            if (stopped) return false;
+
+            if (!found || eval > out.score) {
+                found = true;
+                out.move = rootMove;
+                out.score = eval;
+                out.pv.assign(1, rootMove);
+                for (int i = 1; i < stack[1].pvLength; i++) out.pv.push_back(stack[1].pv[i]);
+            }
+
+            if (eval > alpha) alpha = eval;
+        }
+
+        return found;
+    }
+
+    // Book move for the position, picked at random by weight; false when the
+    // book has none or its move is not legal here (e.g. a hash collision)
+    bool probeBook(MoveValidator& validator, const BitboardEngine& eng, const std::vector<Move>& rootMoves,
+                   int color, Move& out) {
+        uint16_t stored;
+        if (!Book::isLoaded() || !Book::pick(Book::key(eng, validator, color), rng, stored)) return false;
+
+        Move bookMove = Book::decodeMove(stored, eng, color);
+        for (const Move& rootMove : rootMoves) {
+            if (!sameMove(rootMove, bookMove)) continue;
+            out = rootMove;
+            if (g_debugOutput) {
+                std::cout << "\n=== Botv3 Book ===\n  Best: " << MoveValidator::moveToString(out) << "\n" << std::endl;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // Root move by tablebase: the one leading to the best result for us, i.e.
+    // the fastest win, otherwise a draw, otherwise the slowest loss. False when
+    // the position or any of its successors has no loaded table.
+    bool tablebaseMove(MoveValidator& validator, BitboardEngine& eng, const std::vector<Move>& rootMoves,
+                       int color, Move& out) {
+        if (__builtin_popcountll(eng.allPieces) > Tablebase::maxPieces()) return false;
+
+        SearchStack& ss = stack[0];
+        saveState(ss, eng, validator);
+        int bestScore = NEG_INF;
+        bool covered = true;
+        for (const Move& rootMove : rootMoves) {
+            ss.currentMove = rootMove;
+            uint8_t value;
+            if (validator.executeMove(ss.currentMove, color, true)) {
+                covered = Tablebase::probe(eng, 1 - color, value);
+                int score = covered ? -Tablebase::score(value) : NEG_INF;
+                if (score > bestScore) {
+                    bestScore = score;
+                    out = rootMove;
+                }
+            }
+            restoreState(ss, eng, validator);
+            if (!covered) return false;
+        }
+        if (bestScore == NEG_INF) return false;
+
+        if (g_debugOutput) {
+            std::cout << "\n=== Botv3 Tablebase ===\n  Best: "
+                      << BitboardEngine::squareToAlgebraic(out.fromRow, out.fromCol) << " -> "
+                      << BitboardEngine::squareToAlgebraic(out.toRow, out.toCol)
+                      << ", score=" << bestScore << "\n" << std::endl;
+        }
+        return true;
+    }
 
     // Large finite value used as -infinity sentinel.
     // Must NOT be INT_MIN or -INT_MAX: negating those causes overflow/UB
@@ -105,65 +363,129 @@ private:
     static constexpr int NEG_INF = -100000000;
     static constexpr int POS_INF =  100000000;
 
-    int negamax(MoveValidator& validator, BitboardEngine& eng, int depth, int currentColor, int alpha, int beta) {
+    int negamax(MoveValidator& validator, BitboardEngine& eng, int depth, int currentColor, int alpha, int beta, int ply) {
+        SearchStack& ss = stack[ply];
+        ss.pvLength = ply;
+        if (outOfBudget()) return 0;
+
+        // Tablebase positions have an exact distance to mate
+        uint8_t tbValue;
+        if (Tablebase::maxPieces() && __builtin_popcountll(eng.allPieces) <= Tablebase::maxPieces()
+            && Tablebase::probe(eng, currentColor, tbValue)) {
+            return Tablebase::score(tbValue, ply);
+        }
+
+        // King + pawn vs king: the bitbase knows the exact result
+        int kpkScore;
+        if (Endgame::probeKpk(eng, currentColor, kpkScore)) return kpkScore;
+
         if (depth == 0) {
-            return quiescence(validator, eng, currentColor, alpha, beta, 0);
+            return quiescence(validator, eng, currentColor, alpha, beta, 0, ply);
+        }
+
+        // Transposition table: cut off on a deep enough bound, otherwise use its move for ordering
+        uint64_t key = validator.getPositionKey(currentColor);
+        uint16_t ttMove = 0;
+        TranspositionTable::Entry entry;
+        if (tt.probe(key, ply, entry)) {
+            ttHits++;
+            ttMove = entry.move;
+            if (entry.depth >= depth) {
+                if (entry.bound() == TranspositionTable::BOUND_EXACT) return entry.score;
+                if (entry.bound() == TranspositionTable::BOUND_LOWER && entry.score >= beta) return entry.score;
+                if (entry.bound() == TranspositionTable::BOUND_UPPER && entry.score <= alpha) return entry.score;
+            }
         }
+        int origAlpha = alpha;
 
-        std::vector<Move> moves = generateAllMoves(eng, validator, currentColor);
+        ss.moveCount = generateAllMoves(eng, validator, currentColor, ss.moves);
 
-        if (moves.empty()) {
+        if (ss.moveCount == 0) {
             if (validator.isKingInCheck(currentColor)) {
-                return -100000 - depth;  // Checkmate: more negative = mated sooner = worse
+                return -(MATE_SCORE - ply);  // Checkmate: more negative = mated sooner = worse
             }
             return 0;  // Stalemate
         }
 
-        Move noMove(0, 0, 0, 0);
-        orderMoves(moves, eng, noMove);
+        // On the previous PV its move goes first, ahead of the TT move
+        Move pvMove(0, 0, 0, 0);
+        if (followPv) {
+            if (ply < rootPvLength) pvMove = rootPv[ply];
+            else followPv = false;
+        }
+        bool onPv = followPv;
+        orderMoves(ss.moves, ss.moveCount, eng, pvMove, ttMove, ss.killers);
 
         int best = NEG_INF;
+        uint16_t bestMove = 0;
         bool anyMoveMade = false;
 
-        for (auto& move : moves) {
-            EngineState engState = saveEngineState(eng);
-            MoveValidator::ValidatorState valState = validator.getState();
-            Move m = move;
+        for (int i = 0; i < ss.moveCount; i++) {
+            const Move& move = ss.moves[i];
+            saveState(ss, eng, validator);
+            ss.currentMove = move;
 
             // FIX 1: if executeMove rejects a generated move, skip it cleanly
             // rather than evaluating the unchanged (wrong) position.
             // Without this, best stays at NEG_INF and the parent sees an
             // enormous score after negation, corrupting the entire search.
-            if (!validator.executeMove(m, currentColor, true)) {
-                restoreEngineState(eng, engState);
-                validator.setState(valState);
+            if (!validator.executeMove(ss.currentMove, currentColor, true)) {
+                restoreState(ss, eng, validator);
                 continue;
             }
 
             anyMoveMade = true;
-            int eval = -negamax(validator, eng, depth - 1, 1 - currentColor, -beta, -alpha);
-            restoreEngineState(eng, engState);
-            validator.setState(valState);
-
-            if (eval > best)  best = eval;
-            if (eval > alpha) alpha = eval;
-            if (alpha >= beta) break;  // Beta cutoff
+            followPv = onPv && sameMove(move, pvMove);
+            int eval = -negamax(validator, eng, depth - 1, 1 - currentColor, -beta, -alpha, ply + 1);
+            followPv = false;
+            restoreState(ss, eng, validator);
+            if (stopped) return 0;  // aborted subtree: score is meaningless, don't store it
+
+            if (eval > best) {
+                best = eval;
+                bestMove = TranspositionTable::packMove(move);
+            }
+            if (eval > alpha) {
+                alpha = eval;
+                // Extend the PV: this move followed by the child's best line
+                const SearchStack& child = stack[ply + 1];
+                ss.pv[ply] = move;
+                for (int j = ply + 1; j < child.pvLength; j++) ss.pv[j] = child.pv[j];
+                ss.pvLength = child.pvLength;
+            }
+            if (alpha >= beta) {
+                // Beta cutoff: remember quiet refutations for sibling nodes
+                bool quiet = ss.currentMove.capturedPiece == -1 && !ss.currentMove.isPawnPromotion;
+                if (quiet && !sameMove(move, ss.killers[0])) {
+                    ss.killers[1] = ss.killers[0];
+                    ss.killers[0] = move;
+                }
+                break;
+            }
         }
 
         // FIX 1 (continued): if every generated move was rejected by executeMove,
         // fall back to a correct terminal score rather than returning NEG_INF.
         if (!anyMoveMade) {
             if (validator.isKingInCheck(currentColor)) {
-                return -100000 - depth;
+                return -(MATE_SCORE - ply);
             }
             return 0;
         }
 
+        TranspositionTable::Bound bound = (best >= beta)      ? TranspositionTable::BOUND_LOWER
+                                        : (best > origAlpha) ? TranspositionTable::BOUND_EXACT
+                                                             : TranspositionTable::BOUND_UPPER;
+        tt.store(key, depth, ply, best, bound, bestMove);
+
         return best;
     }
 
-    int quiescence(MoveValidator& validator, BitboardEngine& eng, int currentColor, int alpha, int beta, int qDepth) {
+    int quiescence(MoveValidator& validator, BitboardEngine& eng, int currentColor, int alpha, int beta, int qDepth, int ply) {
         positionsEvaluated++;
+        SearchStack& ss = stack[ply];
+        ss.pvLength = ply;  // PV is not extended through quiescence
+        if (qDepth > 0 && outOfBudget()) return 0;  // qDepth 0 was counted by negamax
 
         bool inCheck = validator.isKingInCheck(currentColor);
 
@@ -175,38 +497,37 @@ private:
             return score;
         }
 
+        Move noMove(0, 0, 0, 0);
+
         if (inCheck) {
             // In check: must find an escape. Stand-pat is unsound here because
             // the side to move MUST make a move — the current position isn't an
             // option. Search ALL legal moves (not just captures) to find evasions.
             int best = NEG_INF;
 
-            std::vector<Move> moves = generateAllMoves(eng, validator, currentColor);
-            if (moves.empty()) {
+            ss.moveCount = generateAllMoves(eng, validator, currentColor, ss.moves);
+            if (ss.moveCount == 0) {
                 // Checkmate
-                return -100000 + qDepth;
+                return -(MATE_SCORE - ply);
             }
 
-            Move noMove(0, 0, 0, 0);
-            orderMoves(moves, eng, noMove);
+            orderMoves(ss.moves, ss.moveCount, eng, noMove);
 
             bool anyMoveMade = false;
-            for (auto& move : moves) {
-                EngineState engState = saveEngineState(eng);
-                MoveValidator::ValidatorState valState = validator.getState();
-                Move m = move;
-
-                if (!validator.executeMove(m, currentColor, true)) {
-                    restoreEngineState(eng, engState);
-                    validator.setState(valState);
+            for (int i = 0; i < ss.moveCount; i++) {
+                saveState(ss, eng, validator);
+                ss.currentMove = ss.moves[i];
+
+                if (!validator.executeMove(ss.currentMove, currentColor, true)) {
+                    restoreState(ss, eng, validator);
                     continue;
                 }
 
                 anyMoveMade = true;
-                int eval = -quiescence(validator, eng, 1 - currentColor, -beta, -alpha, qDepth + 1);
+                int eval = -quiescence(validator, eng, 1 - currentColor, -beta, -alpha, qDepth + 1, ply + 1);
 
-                restoreEngineState(eng, engState);
-                validator.setState(valState);
+                restoreState(ss, eng, validator);
+                if (stopped) return 0;
 
                 if (eval > best)  best = eval;
                 if (best >= beta) return best;
@@ -214,41 +535,38 @@ private:
             }
 
             if (!anyMoveMade) {
-                return -100000 + qDepth; // checkmate
+                return -(MATE_SCORE - ply); // checkmate
             }
 
             return best;
         }
 
         // Not in check: normal quiescence with stand-pat + captures only
-        int standPat = evaluate(eng);
-        standPat = (currentColor == 0) ? standPat : -standPat;
+        int standPat = evaluate(eng, currentColor, alpha, beta);
+        ss.staticEval = standPat;
 
         int best = standPat;
         if (best >= beta)  return best;
         if (best > alpha)  alpha = best;
 
-        std::vector<Move> moves = generateCaptureMoves(eng, validator, currentColor);
-        if (moves.empty()) return best;
+        ss.moveCount = generateCaptureMoves(eng, validator, currentColor, ss.moves);
+        if (ss.moveCount == 0) return best;
 
-        Move noMove(0, 0, 0, 0);
-        orderMoves(moves, eng, noMove);
+        orderMoves(ss.moves, ss.moveCount, eng, noMove);
 
-        for (auto& move : moves) {
-            EngineState engState = saveEngineState(eng);
-            MoveValidator::ValidatorState valState = validator.getState();
-            Move m = move;
+        for (int i = 0; i < ss.moveCount; i++) {
+            saveState(ss, eng, validator);
+            ss.currentMove = ss.moves[i];
 
-            if (!validator.executeMove(m, currentColor, true)) {
-                restoreEngineState(eng, engState);
-                validator.setState(valState);
+            if (!validator.executeMove(ss.currentMove, currentColor, true)) {
+                restoreState(ss, eng, validator);
                 continue;
             }
 
-            int eval = -quiescence(validator, eng, 1 - currentColor, -beta, -alpha, qDepth + 1);
+            int eval = -quiescence(validator, eng, 1 - currentColor, -beta, -alpha, qDepth + 1, ply + 1);
 
-            restoreEngineState(eng, engState);
-            validator.setState(valState);
+            restoreState(ss, eng, validator);
+            if (stopped) return 0;
 
             if (eval > best)  best = eval;
             if (best >= beta) return best;
@@ -258,12 +576,32 @@ private:
         return best;
     }
 
-    static int scoreMove(const Move& move, const BitboardEngine& eng, const Move& prevBest) {
+    static bool sameMove(const Move& a, const Move& b) {
+        return a.fromRow == b.fromRow && a.fromCol == b.fromCol &&
+               a.toRow   == b.toRow   && a.toCol   == b.toCol &&
+               a.promotedTo == b.promotedTo;
+    }
+
+    static std::string pvToString(const std::vector<Move>& pv) {
+        std::string s;
+        for (size_t i = 0; i < pv.size(); i++) {
+            if (i > 0) s += ' ';
+            s += MoveValidator::moveToString(pv[i]);
+        }
+        return s;
+    }
+
+    static int scoreMove(const Move& move, const BitboardEngine& eng, const Move& prevBest,
+                         uint16_t ttMove, const Move* killers) {
         if (move.fromRow == prevBest.fromRow && move.fromCol == prevBest.fromCol &&
             move.toRow   == prevBest.toRow   && move.toCol   == prevBest.toCol) {
             return 100000;
         }
 
+        if (TranspositionTable::matches(move, ttMove)) {
+            return 90000;
+        }
+
         if (move.promotedTo != -1) {
             return 50000 + pieceValue(move.promotedTo);
         }
@@ -275,6 +613,10 @@ private:
             int attacker = eng.getPieceAt(move.fromRow, move.fromCol);
             score += pieceValue(captured) * 10 - pieceValue(attacker);
             score += 10000;
+        } else if (killers) {
+            // Killers rank below every capture but above other quiet moves
+            if (sameMove(move, killers[0])) return 9000;
+            if (sameMove(move, killers[1])) return 8000;
         }
 
         return score;
@@ -292,19 +634,56 @@ private:
         }
     }
 
-    static void orderMoves(std::vector<Move>& moves, const BitboardEngine& eng, const Move& prevBest) {
-        std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
-            return scoreMove(a, eng, prevBest) > scoreMove(b, eng, prevBest);
+    static void orderMoves(Move* moves, int count, const BitboardEngine& eng, const Move& prevBest,
+                           uint16_t ttMove = 0, const Move* killers = nullptr) {
+        std::sort(moves, moves + count, [&](const Move& a, const Move& b) {
+            return scoreMove(a, eng, prevBest, ttMove, killers) > scoreMove(b, eng, prevBest, ttMove, killers);
         });
     }
 
-    static int evaluate(const BitboardEngine& eng) {
-        return Eval::evaluate(eng);
+    static void orderMoves(std::vector<Move>& moves, const BitboardEngine& eng, const Move& prevBest) {
+        orderMoves(moves.data(), (int)moves.size(), eng, prevBest);
+    }
+
+    int evaluate(const BitboardEngine& eng) {
+        int score;
+        if (evalCache.probe(eng.zobristKey, score)) return score;
+        score = Eval::evaluate(eng, useNnue);
+        evalCache.store(eng.zobristKey, score);
+        return score;
+    }
+
+    // Stand-pat score for the side to move, against its (alpha, beta) window.
+    int evaluate(const BitboardEngine& eng, int color, int alpha, int beta) {
+        int score;
+        if (!evalCache.probe(eng.zobristKey, score)) {
+            bool lazy;
+            int lo = (color == 0) ? alpha : -beta;
+            int hi = (color == 0) ? beta : -alpha;
+            score = Eval::evaluateLazy(eng, lo, hi, useNnue, lazy);
+            if (lazy) {
+                lazyEvals++;
+            } else {
+                // Exact scores only: a probe can't tell a stored bound from an
+                // exact score, so caching a lazy result would hand it out as one
+                evalCache.store(eng.zobristKey, score);
+            }
+        }
+        return (color == 0) ? score : -score;
     }
 
+    // Root move list (outside the search, so a vector is fine here)
     std::vector<Move> generateAllMoves(const BitboardEngine& eng, MoveValidator& validator, int color) {
-        std::vector<Move> allMoves;
+        Move* buffer = stack[0].moves;
+        int count = generateAllMoves(eng, validator, color, buffer);
+        return std::vector<Move>(buffer, buffer + count);
+    }
+
+    // Writes every legal move (promotions expanded) into out, returns the count
+    int generateAllMoves(const BitboardEngine& eng, MoveValidator& validator, int color, Move* out) {
+        int count = 0;
         int promoRank = (color == 0) ? 0 : 7;
+        Move pieceMoves[MoveValidator::MAX_PIECE_MOVES];
 
         for (int row = 0; row < 8; row++) {
             for (int col = 0; col < 8; col++) {
@@ -314,9 +693,10 @@ private:
                 if (pieceColor != color) continue;
 
                 bool isPawn = (piece / 2 == 0);
-                auto moves = validator.getValidMoves(row, col, color);
+                int n = validator.getValidMoves(row, col, color, pieceMoves);
 
-                for (auto& m : moves) {
+                for (int i = 0; i < n; i++) {
+                    const Move& m = pieceMoves[i];
                     if (isPawn && m.toRow == promoRank) {
                         int pieces[4] = {
                             (color == 0) ? BitboardEngine::WHITE_QUEEN  : BitboardEngine::BLACK_QUEEN,
@@ -325,22 +705,24 @@ private:
                             (color == 0) ? BitboardEngine::WHITE_KNIGHT : BitboardEngine::BLACK_KNIGHT
                         };
                         for (int p : pieces) {
-                            Move pm = m;
-                            pm.promotedTo = p;
-                            allMoves.push_back(pm);
+                            out[count] = m;
+                            out[count].promotedTo = p;
+                            count++;
                         }
                     } else {
-                        allMoves.push_back(m);
+                        out[count++] = m;
                     }
                 }
             }
         }
-        return allMoves;
+        return count;
     }
 
-    std::vector<Move> generateCaptureMoves(const BitboardEngine& eng, MoveValidator& validator, int color) {
-        std::vector<Move> captureMoves;
+    // Writes captures, en passant and (queen) promotions into out, returns the count
+    int generateCaptureMoves(const BitboardEngine& eng, MoveValidator& validator, int color, Move* out) {
+        int count = 0;
         int promoRank = (color == 0) ? 0 : 7;
+        Move pieceMoves[MoveValidator::MAX_PIECE_MOVES];
 
         for (int row = 0; row < 8; row++) {
             for (int col = 0; col < 8; col++) {
@@ -350,61 +732,25 @@ private:
                 if (pieceColor != color) continue;
 
                 bool isPawn = (piece / 2 == 0);
-                auto moves = validator.getValidMoves(row, col, color);
+                int n = validator.getValidMoves(row, col, color, pieceMoves);
 
-                for (auto& m : moves) {
+                for (int i = 0; i < n; i++) {
+                    const Move& m = pieceMoves[i];
                     bool isCapture    = (eng.getPieceAt(m.toRow, m.toCol) != -1);
                     bool isEnPassant  = isPawn && (m.toCol != m.fromCol) && !isCapture;
                     bool isPromotion  = isPawn && m.toRow == promoRank;
 
                     if (isCapture || isEnPassant || isPromotion) {
+                        out[count] = m;
                         if (isPromotion) {
-                            Move pm = m;
-                            pm.promotedTo = (color == 0) ? BitboardEngine::WHITE_QUEEN
-                                                         : BitboardEngine::BLACK_QUEEN;
-                            captureMoves.push_back(pm);
-                        } else {
-                            captureMoves.push_back(m);
+                            out[count].promotedTo = (color == 0) ? BitboardEngine::WHITE_QUEEN
+                                                                 : BitboardEngine::BLACK_QUEEN;
                         }
+                        count++;
                     }
                 }
             }
         }
-        return captureMoves;
-    }
-
-    struct EngineState {
-        Bitboard pawns[2], rooks[2], knights[2], bishops[2], queens[2], kings[2];
-        Bitboard allWhitePieces, allBlackPieces, allPieces;
-    };
-
-    static EngineState saveEngineState(const BitboardEngine& eng) {
-        EngineState s;
-        for (int i = 0; i < 2; i++) {
-            s.pawns[i]   = eng.pawns[i];
-            s.rooks[i]   = eng.rooks[i];
-            s.knights[i] = eng.knights[i];
-            s.bishops[i] = eng.bishops[i];
-            s.queens[i]  = eng.queens[i];
-            s.kings[i]   = eng.kings[i];
-        }
-        s.allWhitePieces = eng.allWhitePieces;
-        s.allBlackPieces = eng.allBlackPieces;
-        s.allPieces      = eng.allPieces;
-        return s;
-    }
-
-    static void restoreEngineState(BitboardEngine& eng, const EngineState& s) {
-        for (int i = 0; i < 2; i++) {
-            eng.pawns[i]   = s.pawns[i];
-            eng.rooks[i]   = s.rooks[i];
-            eng.knights[i] = s.knights[i];
-            eng.bishops[i] = s.bishops[i];
-            eng.queens[i]  = s.queens[i];
-            eng.kings[i]   = s.kings[i];
-        }
-        eng.allWhitePieces = s.allWhitePieces;
-        eng.allBlackPieces = s.allBlackPieces;
-        eng.allPieces      = s.allPieces;
+        return count;
     }
 };
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "Analysis.h"
+#include "BenchPositions.h"
+#include "botv2.h"
+#include "botv3.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <omp.h>
+
+namespace {
+
+// Analysis opcodes written by this mode (replaced if the input already has them)
+bool isAnalysisOpcode(const std::string& opcode) {
+    return opcode == "sm" || opcode == "ce" || opcode == "acd" || opcode == "acn" || opcode == "acs" || opcode == "pv";
+}
+
+bool sameMove(const Move& a, const Move& b) {
+    return a.fromRow == b.fromRow && a.fromCol == b.fromCol && a.toRow == b.toRow && a.toCol == b.toCol
+        && a.promotedTo == b.promotedTo;
+}
+
+// True if move is one of the operation's moves (SAN, parsed in the position)
+bool listed(MoveValidator& validator, const EpdOperation& op, int color, const Move& move) {
+    for (const std::string& text : op.operands) {
+        Move m;
+        if (validator.parseMove(text, color, m) && sameMove(m, move)) return true;
+    }
+    return false;
+}
+
+struct Result {
+    std::string line;   // output line (without newline)
+    bool scored = false;  // had a bm or am operation
+    bool solved = false;
+    int64_t nodes = 0;
+    bool done = false;
+};
+
+// Searches the position on validator's engine and describes it; the position is left unchanged
+void analyze(Botv3& bot, MoveValidator& validator, const FenState& state, std::vector<EpdOperation> ops, Result& out) {
+    BitboardEngine& eng = *validator.getEngine();
+    int color = state.sideToMove;
+
+    bot.newGame();  // positions are independent: nothing carries over in the TT
+    auto start = std::chrono::steady_clock::now();
+    Move best = bot.chooseMove(eng, validator, color);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<EpdOperation> outOps;
+    for (EpdOperation& op : ops) {
+        if (!isAnalysisOpcode(op.opcode)) outOps.push_back(std::move(op));
+    }
+    if (!validator.hasAnyLegalMoves(color)) {
+        outOps.push_back({ "c0", { validator.isKingInCheck(color) ? "checkmated" : "stalemate" } });
+        out.line = validator.toEpd(color, outOps);
+        return;
+    }
+
+    for (const EpdOperation& op : outOps) {
+        if (op.opcode != "bm" && op.opcode != "am") continue;
+        bool hit = listed(validator, op, color, best);
+        out.solved = (out.scored ? out.solved : true) && (op.opcode == "bm" ? hit : !hit);
+        out.scored = true;
+    }
+
+    char acs[32];
+    std::snprintf(acs, sizeof(acs), "%.3f", seconds);
+    outOps.push_back({ "sm", { validator.moveToSan(best, color) } });
+    const std::vector<Botv3::PvLine>& lines = bot.getMultiPVResults();
+    if (!lines.empty()) outOps.push_back({ "ce", { std::to_string(lines[0].score) } });
+    outOps.push_back({ "acd", { std::to_string(bot.getCompletedDepth()) } });
+    outOps.push_back({ "acn", { std::to_string(bot.getNodes()) } });
+    outOps.push_back({ "acs", { acs } });
+
+    // The principal variation in SAN, played out and then taken back
+    if (!lines.empty()) {
+        EpdOperation pv{ "pv", {} };
+        BitboardEngine::EngineState engState = eng.getState();
+        MoveValidator::ValidatorState valState = validator.getState();
+        int side = color;
+        for (Move m : lines[0].pv) {
+            pv.operands.push_back(validator.moveToSan(m, side));
+            validator.executeMove(m, side, true);
+            side ^= 1;
+        }
+        eng.setState(engState);
+        validator.setState(valState);
+        outOps.push_back(std::move(pv));
+    }
+
+    out.nodes = bot.getNodes();
+    out.line = validator.toEpd(color, outOps);
+}
+
+// Searches every bench position with bot; returns the node total and adds the elapsed seconds
+int64_t benchBot(ChessBot& bot, int depth, double& seconds) {
+    bot.setMaxDepth(depth);
+    bot.setSeed(0);  // Botv2 breaks ties at random
+    BitboardEngine eng;
+    MoveValidator validator(&eng);
+    int64_t total = 0;
+    int index = 0;
+    for (const char* fen : Bench::POSITIONS) {
+        index++;
+        FenState state;
+        if (!validator.loadFen(fen, state)) {
+            std::cerr << "Error: bad bench position " << index << std::endl;
+            continue;
+        }
+        bot.newGame();
+        auto start = std::chrono::steady_clock::now();
+        Move best = bot.chooseMove(eng, validator, state.sideToMove);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        total += bot.getNodes();
+        std::cout << "  " << bot.getName() << " position " << std::setw(2) << index << ": "
+                  << std::setw(10) << bot.getNodes() << " nodes, " << MoveValidator::moveToString(best) << std::endl;
+    }
+    return total;
+}
+
+}
+
+namespace Analysis {
+
+int bench(int depth, bool includeBotv2) {
+    Botv3 botv3;
+    Botv2 botv2;
+    std::vector<ChessBot*> bots = { &botv3 };
+    if (includeBotv2) bots.push_back(&botv2);
+
+    int64_t nodes = 0;
+    double seconds = 0;
+    for (ChessBot* bot : bots) {
+        double botSeconds = 0;
+        int64_t botNodes = benchBot(*bot, depth, botSeconds);
+        nodes += botNodes;
+        seconds += botSeconds;
+        if (bots.size() > 1) {
+            std::cout << "  " << bot->getName() << ": " << botNodes << " nodes, "
+                      << static_cast<int64_t>(botSeconds > 0 ? botNodes / botSeconds : 0) << " nps" << std::endl;
+        }
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "        Bench (depth " << depth << ", " << std::size(Bench::POSITIONS) << " positions)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Nodes:  " << nodes << std::endl;
+    std::cout << "  Time:   " << static_cast<int64_t>(seconds * 1000) << " ms" << std::endl;
+    std::cout << "  NPS:    " << static_cast<int64_t>(seconds > 0 ? nodes / seconds : 0) << std::endl;
+    std::cout << "========================================\n" << std::endl;
+    return 0;
+}
+
+
+int analyzeEpd(const GameConfig& config, int searchDepth, bool useNnue, const Eval::Weights* weights) {
+    std::ifstream in(config.analyzeEpdFile);
+    if (!in) {
+        std::cerr << "Error: cannot open EPD file '" << config.analyzeEpdFile << "'" << std::endl;
+        return 1;
+    }
+    std::vector<std::string> positions;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.find_first_not_of(" \t") == std::string::npos || line[0] == '#') continue;
+        positions.push_back(line);
+    }
+
+    std::ofstream file;
+    if (!config.analyzeOutFile.empty()) {
+        file.open(config.analyzeOutFile);
+        if (!file) {
+            std::cerr << "Error: cannot write '" << config.analyzeOutFile << "'" << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = config.analyzeOutFile.empty() ? std::cout : file;
+
+    int total = static_cast<int>(positions.size());
+    std::vector<Result> results(total);
+    int nextToWrite = 0;
+    auto start = std::chrono::steady_clock::now();
+
+#pragma omp parallel
+    {
+        // Each worker owns its bot and position (bots have mutable search state)
+        Botv3 bot;
+        if (searchDepth > 0) bot.setMaxDepth(searchDepth);
+        bot.setNodeLimit(config.nodes);
+        bot.setTimeLimit(config.moveTimeMs);
+        bot.setUseNnue(useNnue);
+        bot.setEvalWeights(weights);
+        BitboardEngine eng;
+        MoveValidator validator(&eng);
+
+#pragma omp for schedule(dynamic)
+        for (int i = 0; i < total; i++) {
+            FenState state;
+            std::vector<EpdOperation> ops;
+            Result result;
+            if (validator.loadEpd(positions[i], state, &ops)) {
+                analyze(bot, validator, state, std::move(ops), result);
+            } else {
+                result.line = "# not a valid EPD position: " + positions[i];
+            }
+
+            // Stream finished lines in input order
+#pragma omp critical(analysis_output)
+            {
+                results[i] = std::move(result);
+                results[i].done = true;
+                while (nextToWrite < total && results[nextToWrite].done) {
+                    out << results[nextToWrite].line << '\n';
+                    results[nextToWrite].line.clear();
+                    nextToWrite++;
+                }
+                out.flush();
+                if (file.is_open()) std::cerr << "\rAnalyzed " << nextToWrite << "/" << total << std::flush;
+            }
+        }
+    }
+    if (file.is_open()) std::cerr << std::endl;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int scored = 0, solved = 0;
+    int64_t nodes = 0;
+    for (const Result& r : results) {
+        scored += r.scored;
+        solved += r.solved;
+        nodes += r.nodes;
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "        EPD Analysis (" << total << " positions)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    if (scored > 0) {
+        std::cout << "  Solved: " << solved << "/" << scored << " ("
+                  << (solved * 1000 / scored) / 10.0 << "%)" << std::endl;
+    }
+    std::cout << "  Nodes:  " << nodes << std::endl;
+    std::cout << "  Time:   " << static_cast<int64_t>(seconds * 1000) << " ms (" << omp_get_max_threads() << " threads)" << std::endl;
+    std::cout << "  NPS:    " << static_cast<int64_t>(seconds > 0 ? nodes / seconds : 0) << std::endl;
+    std::cout << "========================================\n" << std::endl;
+    return 0;
+}
+
+}
@@ -1,13 +1,18 @@
 #include "BitboardEngine.h"
+#include "Zobrist.h"
+#include "Evaluation.h"
+#include "Endgame.h"
+#include "Nnue.h"
 #include <iostream>
 #include <iomanip>
+#include <cstring>
 
 extern bool g_debugOutput;
 
 /* This bitboard is a 64-bit representation of the chessboard, where each bit corresponds to a square. 
    This means each piece type for each color is represented by a separate 64-bit integer, allowing for efficient bitwise operations. */
 
-BitboardEngine::BitboardEngine() {
+BitboardEngine::BitboardEngine() : weights(&Eval::DEFAULT_WEIGHTS) {
     initializeStartingPosition();
 }
 
@@ -48,6 +53,8 @@ void BitboardEngine::initializeStartingPosition() {
     allWhitePieces = pawns[0] | rooks[0] | knights[0] | bishops[0] | queens[0] | kings[0];
     allBlackPieces = pawns[1] | rooks[1] | knights[1] | bishops[1] | queens[1] | kings[1];
     allPieces = allWhitePieces | allBlackPieces;
+    
+    refreshIncrementalState();
 }
 
 // Convert (row, col) to a bitboard index (0-63)
@@ -122,6 +129,7 @@ void BitboardEngine::setPieceAt(int row, int col, int piece) {
     
     // Clear the square first
     clearSquare(row, col);
+    if (piece != EMPTY) onPieceAdded(piece, index);
     
     // Set the piece
     switch (piece) {
@@ -174,6 +182,9 @@ void BitboardEngine::clearSquare(int row, int col) {
     int index = squareToIndex(row, col);
     uint64_t mask = ~(1ULL << index);
     
+    int oldPiece = getPieceAt(row, col);
+    if (oldPiece != EMPTY) onPieceRemoved(oldPiece, index);
+    
     pawns[0] &= mask;
     pawns[1] &= mask;
     rooks[0] &= mask;
@@ -204,6 +215,12 @@ void BitboardEngine::movePiece(int fromRow, int fromCol, int toRow, int toCol) {
         uint64_t fromMask = ~(1ULL << fromIndex);
         uint64_t toMask = ~(1ULL << toIndex);
         
+        // Take out the moving piece and any captured piece, put in the arrival
+        int captured = getPieceAt(toRow, toCol);
+        if (captured != EMPTY) onPieceRemoved(captured, toIndex);
+        onPieceRemoved(piece, fromIndex);
+        onPieceAdded(piece, toIndex);
+        
         // Clear both squares from all bitboards
         for (int i = 0; i < 2; i++) {
             pawns[i] &= fromMask & toMask;
@@ -277,3 +294,112 @@ void BitboardEngine::updateCombinedBitboards() {
     allBlackPieces = pawns[1] | rooks[1] | knights[1] | bishops[1] | queens[1] | kings[1];
     allPieces = allWhitePieces | allBlackPieces;
 }
+
+uint64_t BitboardEngine::computeZobristKey() const {
+    const Bitboard* boards[12] = {
+        &pawns[0], &pawns[1], &rooks[0], &rooks[1], &knights[0], &knights[1],
+        &bishops[0], &bishops[1], &queens[0], &queens[1], &kings[0], &kings[1]
+    };
+    uint64_t key = 0;
+    for (int piece = 0; piece < 12; piece++) {
+        Bitboard bb = *boards[piece];
+        while (bb) {
+            key ^= Zobrist::pieceKey(piece, __builtin_ctzll(bb));
+            bb &= bb - 1;
+        }
+    }
+    return key;
+}
+
+void BitboardEngine::setWeights(const Eval::Weights* w) {
+    if (!w) w = &Eval::DEFAULT_WEIGHTS;
+    if (w == weights) return;
+    weights = w;
+    refreshIncrementalState();
+}
+
+void BitboardEngine::refreshIncrementalState() {
+    zobristKey = computeZobristKey();
+    pawnKey = 0;
+    for (int color = 0; color < 2; color++) {
+        Bitboard bb = pawns[color];
+        while (bb) {
+            pawnKey ^= Zobrist::pieceKey(WHITE_PAWN + color, __builtin_ctzll(bb));
+            bb &= bb - 1;
+        }
+    }
+    const Bitboard* boards[6] = { pawns, rooks, knights, bishops, queens, kings };
+    materialKey = 0;
+    for (int piece = 0; piece < 12; piece++) {
+        materialKey += __builtin_popcountll(boards[piece / 2][piece % 2]) * Endgame::materialUnit(piece);
+    }
+    psqt = Eval::computePsqt(*this);
+    nnueAcc.dirty[0] = nnueAcc.dirty[1] = true;
+}
+
+bool BitboardEngine::loadPlacement(const std::string& fen) {
+    // Piece letters in piece-constant order: P p R r N n B b Q q K k
+    static const char LETTERS[] = "PpRrNnBbQqKk";
+    Bitboard boards[12] = {};
+    int row = 0, col = 0;
+    for (char c : fen) {
+        if (c == ' ') break;
+        if (c == '/') {
+            if (col != 8 || ++row > 7) return false;
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            col += c - '0';
+            if (col > 8) return false;
+        } else {
+            const char* letter = c ? std::strchr(LETTERS, c) : nullptr;
+            if (!letter || col > 7) return false;
+            boards[letter - LETTERS] |= 1ULL << squareToIndex(row, col++);
+        }
+    }
+    if (row != 7 || col != 8) return false;
+    if (__builtin_popcountll(boards[WHITE_KING]) != 1 || __builtin_popcountll(boards[BLACK_KING]) != 1) return false;
+
+    Bitboard* sets[6] = { pawns, rooks, knights, bishops, queens, kings };
+    for (int piece = 0; piece < 12; piece++) sets[piece / 2][piece % 2] = boards[piece];
+    updateCombinedBitboards();
+    refreshIncrementalState();
+    return true;
+}
+
+std::string BitboardEngine::placementFen() const {
+    static const char LETTERS[] = "PpRrNnBbQqKk";
+    std::string fen;
+    fen.reserve(71);
+    for (int row = 0; row < 8; row++) {
+        int empty = 0;
+        for (int col = 0; col < 8; col++) {
+            int piece = getPieceAt(row, col);
+            if (piece == EMPTY) {
+                empty++;
+                continue;
+            }
+            if (empty) fen += static_cast<char>('0' + empty);
+            empty = 0;
+            fen += LETTERS[piece];
+        }
+        if (empty) fen += static_cast<char>('0' + empty);
+        if (row < 7) fen += '/';
+    }
+    return fen;
+}
+
+void BitboardEngine::onPieceAdded(int piece, int index) {
+    zobristKey ^= Zobrist::pieceKey(piece, index);
+    if (piece / 2 == 0) pawnKey ^= Zobrist::pieceKey(piece, index);
+    materialKey += Endgame::materialUnit(piece);
+    psqt += Eval::pieceSquareScore(*weights, piece, index);
+    if (Nnue::isLoaded()) Nnue::pieceAdded(nnueAcc, *this, piece, index);
+}
+
+void BitboardEngine::onPieceRemoved(int piece, int index) {
+    zobristKey ^= Zobrist::pieceKey(piece, index);
+    if (piece / 2 == 0) pawnKey ^= Zobrist::pieceKey(piece, index);
+    materialKey -= Endgame::materialUnit(piece);
+    psqt -= Eval::pieceSquareScore(*weights, piece, index);
+    if (Nnue::isLoaded()) Nnue::pieceRemoved(nnueAcc, *this, piece, index);
+}
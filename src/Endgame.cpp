@@ -0,0 +1,234 @@
+#include "Endgame.h"
+#include "Evaluation.h"
+#include "Kpk.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+
+namespace Endgame {
+
+namespace {
+
+// Board uses row 0 = rank 8; these work in real ranks so a1 is (0, 0)
+int rankOf(int sq) { return 7 - sq / 8; }
+int fileOf(int sq) { return sq % 8; }
+
+int distance(int a, int b) {
+    return std::max(std::abs(rankOf(a) - rankOf(b)), std::abs(fileOf(a) - fileOf(b)));
+}
+
+// Dark squares (a1, h8, ...) as a bitboard
+constexpr Bitboard makeDarkSquares() {
+    Bitboard b = 0;
+    for (int sq = 0; sq < 64; sq++) {
+        if (((7 - sq / 8) + sq % 8) % 2 == 0) b |= 1ULL << sq;
+    }
+    return b;
+}
+constexpr Bitboard DARK_SQUARES = makeDarkSquares();
+
+// Larger toward the edges and corners, for driving the defending king out
+int pushToEdge(int sq) {
+    int fd = std::min(fileOf(sq), 7 - fileOf(sq));
+    int rd = std::min(rankOf(sq), 7 - rankOf(sq));
+    return 90 - (7 * fd * fd / 2 + 7 * rd * rd / 2);
+}
+
+// Larger the closer the two kings are
+int pushClose(int a, int b) { return 140 - 20 * distance(a, b); }
+
+int king(const BitboardEngine& eng, int color) { return __builtin_ctzll(eng.kings[color]); }
+
+// Endgame material (piece values + pawns) of one side under the engine's weights
+int material(const BitboardEngine& eng, int color) {
+    const Eval::Weights& w = eng.getWeights();
+    const Bitboard* sets[5] = { eng.pawns, eng.rooks, eng.knights, eng.bishops, eng.queens };
+    int total = 0;
+    for (int type = 0; type < 5; type++) {
+        total += __builtin_popcountll(sets[type][color]) * w.pieceValue[type][Eval::EG];
+    }
+    return total;
+}
+
+int fromWhite(int strongScore, int strong) { return strong == 0 ? strongScore : -strongScore; }
+
+// Lone king against enough material to mate: drive it to the edge and bring
+// our king up, so the search has a gradient to follow toward the mating net
+int evaluateKXK(const BitboardEngine& eng, int strong) {
+    int weak = strong ^ 1;
+    int strongKing = king(eng, strong);
+    int weakKing = king(eng, weak);
+
+    int result = material(eng, strong) + pushToEdge(weakKing) + pushClose(strongKing, weakKing);
+
+    Bitboard bishops = eng.bishops[strong];
+    if (eng.queens[strong] || eng.rooks[strong]
+        || ((bishops & DARK_SQUARES) && (bishops & ~DARK_SQUARES))
+        || (bishops && eng.knights[strong])) {
+        result += KNOWN_WIN;
+    }
+    return fromWhite(result, strong);
+}
+
+// KBNK: mate is only possible in a corner of the bishop's colour, and needs
+// the knight close to the defending king as well as our own king
+int evaluateKBNK(const BitboardEngine& eng, int strong) {
+    int weak = strong ^ 1;
+    int strongKing = king(eng, strong);
+    int weakKing = king(eng, weak);
+    int r = rankOf(weakKing), f = fileOf(weakKing);
+
+    // Distance from the long diagonal that doesn't hold the mating corners
+    bool darkBishop = (eng.bishops[strong] & DARK_SQUARES) != 0;
+    int toCorner = darkBishop ? std::abs(7 - r - f) : std::abs(r - f);
+
+    int knight = __builtin_ctzll(eng.knights[strong]);
+    int result = KNOWN_WIN + material(eng, strong) + pushClose(strongKing, weakKing) + 420 * toCorner
+               + pushToEdge(weakKing) + 4 * pushClose(knight, weakKing) / 7;
+    return fromWhite(result, strong);
+}
+
+// Won KPK: large, and larger the further the pawn has advanced
+int kpkWinScore(const BitboardEngine& eng, int strong) {
+    int pawn = __builtin_ctzll(eng.pawns[strong]);
+    int rank = strong == 0 ? 7 - pawn / 8 : pawn / 8;  // relative rank, 1..6
+    return KNOWN_WIN + eng.getWeights().pieceValue[0][Eval::EG] + rank;
+}
+
+// KPK without a side to move: exact when the result doesn't depend on who
+// moves, otherwise the material + PST estimate (search probes the bitbase
+// with the side to move, see probeKpk)
+int evaluateKPK(const BitboardEngine& eng, int strong) {
+    int weak = strong ^ 1;
+    int pawn = __builtin_ctzll(eng.pawns[strong]);
+    bool winStrongToMove = Kpk::probe(king(eng, strong), pawn, king(eng, weak), strong, strong);
+    bool winWeakToMove = Kpk::probe(king(eng, strong), pawn, king(eng, weak), strong, weak);
+    if (winStrongToMove && winWeakToMove) return fromWhite(kpkWinScore(eng, strong), strong);
+    if (!winStrongToMove && !winWeakToMove) return 0;
+    return Eval::egValue(eng.psqt);
+}
+
+// Insufficient material to force mate (KK, KNK, KBK, KNNK)
+int evaluateDraw(const BitboardEngine&, int) { return 0; }
+
+// Bishops of opposite colours (one each, no rooks or queens, see probe()):
+// pure bishop endings are very drawish unless one side is well up in pawns;
+// knights on the board soften that
+int scaleOppositeBishops(const BitboardEngine& eng, int) {
+    bool whiteDark = (eng.bishops[0] & DARK_SQUARES) != 0;
+    bool blackDark = (eng.bishops[1] & DARK_SQUARES) != 0;
+    if (whiteDark == blackDark) return SCALE_NONE;
+
+    if (eng.knights[0] | eng.knights[1]) return 46;
+    int pawnDiff = std::abs(__builtin_popcountll(eng.pawns[0]) - __builtin_popcountll(eng.pawns[1]));
+    return pawnDiff <= 1 ? 16 : 32;
+}
+
+// Material key for a signature like "KBNK": the strong side's pieces up to
+// the second 'K', then the weak side's
+uint64_t signatureKey(const std::string& code, int strong) {
+    uint64_t key = 0;
+    int color = strong;
+    for (size_t i = 0; i < code.size(); i++) {
+        if (code[i] == 'K' && i > 0) color = strong ^ 1;
+        int type;
+        switch (code[i]) {
+            case 'P': type = 0; break;
+            case 'R': type = 1; break;
+            case 'N': type = 2; break;
+            case 'B': type = 3; break;
+            case 'Q': type = 4; break;
+            default:  type = 5; break;
+        }
+        key += materialUnit(type * 2 + color);
+    }
+    return key;
+}
+
+class Registry {
+public:
+    Registry() {
+        add("KRK",  evaluateKXK);
+        add("KQK",  evaluateKXK);
+        add("KBNK", evaluateKBNK);
+        add("KPK",  evaluateKPK);
+        add("KK",   evaluateDraw);
+        add("KNK",  evaluateDraw);
+        add("KBK",  evaluateDraw);
+        add("KNNK", evaluateDraw);
+    }
+
+    const Entry* find(uint64_t key) const {
+        auto it = entries.find(key);
+        return it == entries.end() ? nullptr : &it->second;
+    }
+
+private:
+    void add(const std::string& code, EvalFn fn) {
+        for (int strong = 0; strong < 2; strong++) {
+            entries[signatureKey(code, strong)] = Entry{ fn, nullptr, strong };
+        }
+    }
+
+    std::unordered_map<uint64_t, Entry> entries;
+};
+
+const Entry KXK_ENTRIES[2] = { { evaluateKXK, nullptr, 0 }, { evaluateKXK, nullptr, 1 } };
+const Entry OPPOSITE_BISHOPS_ENTRY = { nullptr, scaleOppositeBishops, 0 };
+
+// Non-pawn material of one side, in middlegame piece values
+int nonPawnMaterial(uint64_t key, int color) {
+    return pieceCount(key, BitboardEngine::WHITE_ROOK + color)   * Eval::MG_ROOK_VAL
+         + pieceCount(key, BitboardEngine::WHITE_KNIGHT + color) * Eval::MG_KNIGHT_VAL
+         + pieceCount(key, BitboardEngine::WHITE_BISHOP + color) * Eval::MG_BISHOP_VAL
+         + pieceCount(key, BitboardEngine::WHITE_QUEEN + color)  * Eval::MG_QUEEN_VAL;
+}
+
+}
+
+bool probeKpk(const BitboardEngine& eng, int sideToMove, int& score) {
+    static const uint64_t KPK_KEYS[2] = { signatureKey("KPK", 0), signatureKey("KPK", 1) };
+    int strong;
+    if (eng.materialKey == KPK_KEYS[0]) strong = 0;
+    else if (eng.materialKey == KPK_KEYS[1]) strong = 1;
+    else return false;
+
+    int pawn = __builtin_ctzll(eng.pawns[strong]);
+    if (!Kpk::probe(king(eng, strong), pawn, king(eng, strong ^ 1), strong, sideToMove)) {
+        score = 0;
+    } else {
+        score = kpkWinScore(eng, strong);
+        if (sideToMove != strong) score = -score;
+    }
+    return true;
+}
+
+const Entry* probe(uint64_t materialKey) {
+    static const Registry registry;
+    if (pieceCount(materialKey, BitboardEngine::WHITE_KING) != 1
+        || pieceCount(materialKey, BitboardEngine::BLACK_KING) != 1) {
+        return nullptr;  // set-up positions without both kings
+    }
+    if (const Entry* e = registry.find(materialKey)) return e;
+
+    // Any other lone-king ending where the strong side has at least a rook's worth
+    for (int strong = 0; strong < 2; strong++) {
+        int weak = strong ^ 1;
+        bool weakBare = nonPawnMaterial(materialKey, weak) == 0
+                     && pieceCount(materialKey, BitboardEngine::WHITE_PAWN + weak) == 0;
+        if (weakBare && nonPawnMaterial(materialKey, strong) >= Eval::MG_ROOK_VAL) return &KXK_ENTRIES[strong];
+    }
+
+    // Opposite bishops only draw when the heavy pieces are gone: with rooks
+    // or queens left the side ahead keeps real winning chances
+    int heavyPieces = pieceCount(materialKey, BitboardEngine::WHITE_ROOK) + pieceCount(materialKey, BitboardEngine::BLACK_ROOK)
+                    + pieceCount(materialKey, BitboardEngine::WHITE_QUEEN) + pieceCount(materialKey, BitboardEngine::BLACK_QUEEN);
+    if (heavyPieces == 0 && pieceCount(materialKey, BitboardEngine::WHITE_BISHOP) == 1
+        && pieceCount(materialKey, BitboardEngine::BLACK_BISHOP) == 1) {
+        return &OPPOSITE_BISHOPS_ENTRY;
+    }
+    return nullptr;
+}
+
+}
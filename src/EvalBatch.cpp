@@ -0,0 +1,223 @@
+#include "Evaluation.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace Eval {
+
+namespace {
+
+constexpr int LANES = 8;  // positions per chunk
+
+// A chunk of positions in structure-of-arrays form, one lane per position.
+// Unused lanes are empty boards.
+struct Batch {
+    alignas(32) Bitboard pieces[12][LANES];
+    alignas(32) uint32_t lo[12][LANES];   // pieces split into squares 0..31
+    alignas(32) uint32_t hi[12][LANES];   // and squares 32..63
+    Bitboard occupied[12];                // per piece, union over the lanes
+    alignas(32) int32_t psqt[LANES];      // packed Score, as BitboardEngine::psqt
+    alignas(32) int32_t count[12][LANES];
+    alignas(32) int64_t mobility[LANES];  // white minus black, as AttackInfo::mobility
+};
+
+void load(Batch& b, const BitboardEngine* positions, int n) {
+    for (int piece = 0; piece < 12; piece++) {
+        b.occupied[piece] = 0;
+        for (int lane = 0; lane < LANES; lane++) {
+            Bitboard bb = 0;
+            if (lane < n) {
+                const BitboardEngine& eng = positions[lane];
+                const Bitboard* sets[6] = { eng.pawns, eng.rooks, eng.knights, eng.bishops, eng.queens, eng.kings };
+                bb = sets[piece / 2][piece % 2];
+            }
+            b.pieces[piece][lane] = bb;
+            b.lo[piece][lane] = static_cast<uint32_t>(bb);
+            b.hi[piece][lane] = static_cast<uint32_t>(bb >> 32);
+            b.occupied[piece] |= bb;
+        }
+    }
+}
+
+#if defined(__AVX2__)
+
+inline __m256i load256(const void* p) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(p)); }
+
+// Shift every 64-bit lane toward higher (S > 0) or lower (S < 0) square indices
+template <int S>
+inline __m256i shiftBy(__m256i v) {
+    if constexpr (S > 0) return _mm256_slli_epi64(v, S);
+    else return _mm256_srli_epi64(v, -S);
+}
+
+// Kogge-Stone fill: squares a slider on gen attacks in the direction that moves
+// S indices per step, stopping at (and including) the first occupied square.
+// mask removes squares reached by wrapping around the board edge.
+template <int S>
+inline __m256i slide(__m256i gen, __m256i empty, __m256i mask) {
+    empty = _mm256_and_si256(empty, mask);
+    gen   = _mm256_or_si256(gen, _mm256_and_si256(empty, shiftBy<S>(gen)));
+    empty = _mm256_and_si256(empty, shiftBy<S>(empty));
+    gen   = _mm256_or_si256(gen, _mm256_and_si256(empty, shiftBy<2 * S>(gen)));
+    empty = _mm256_and_si256(empty, shiftBy<2 * S>(empty));
+    gen   = _mm256_or_si256(gen, _mm256_and_si256(empty, shiftBy<4 * S>(gen)));
+    return _mm256_and_si256(shiftBy<S>(gen), mask);
+}
+
+template <int S>
+inline __m256i step(__m256i gen, __m256i mask) { return _mm256_and_si256(shiftBy<S>(gen), mask); }
+
+// Per-lane popcount (nibble lookup, then byte sums)
+inline __m256i popcount64(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, nibble));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+// Mobility of one side for four lanes starting at lane. computeAttacks sums
+// popcount(attacks & area) piece by piece; here each direction is filled from
+// all of a side's sliders at once. That gives the same total, since two
+// pieces' rays in one direction never overlap (the first ray stops at the
+// second piece, which its own ray doesn't include), and distinct knights
+// jumping by the same offset land on distinct squares.
+__m256i sideMobility(const Batch& b, int lane, int color) {
+    const __m256i notA  = _mm256_set1_epi64x(static_cast<long long>(~FILE_A_MASK));
+    const __m256i notH  = _mm256_set1_epi64x(static_cast<long long>(~FILE_H_MASK));
+    const __m256i notAB = _mm256_set1_epi64x(static_cast<long long>(~(FILE_A_MASK | (FILE_A_MASK << 1))));
+    const __m256i notGH = _mm256_set1_epi64x(static_cast<long long>(~(FILE_H_MASK | (FILE_H_MASK >> 1))));
+    const __m256i all   = _mm256_set1_epi64x(-1);
+    int enemy = color ^ 1;
+
+    __m256i occupied = _mm256_setzero_si256();
+    __m256i own = _mm256_setzero_si256();
+    for (int piece = 0; piece < 12; piece++) {
+        __m256i bb = load256(&b.pieces[piece][lane]);
+        occupied = _mm256_or_si256(occupied, bb);
+        if (piece % 2 == color) own = _mm256_or_si256(own, bb);
+    }
+    __m256i empty = _mm256_andnot_si256(occupied, all);
+
+    // Squares worth moving to: not blocked by our own pieces, not covered by enemy pawns
+    __m256i enemyPawns = load256(&b.pieces[BitboardEngine::WHITE_PAWN + enemy][lane]);
+    __m256i pawnAttacks = enemy == 0
+        ? _mm256_or_si256(step<-9>(enemyPawns, notH), step<-7>(enemyPawns, notA))
+        : _mm256_or_si256(step<9>(enemyPawns, notA), step<7>(enemyPawns, notH));
+    __m256i area = _mm256_andnot_si256(_mm256_or_si256(own, pawnAttacks), all);
+
+    __m256i queens  = load256(&b.pieces[BitboardEngine::WHITE_QUEEN + color][lane]);
+    __m256i orth    = _mm256_or_si256(load256(&b.pieces[BitboardEngine::WHITE_ROOK + color][lane]), queens);
+    __m256i diag    = _mm256_or_si256(load256(&b.pieces[BitboardEngine::WHITE_BISHOP + color][lane]), queens);
+    __m256i knights = load256(&b.pieces[BitboardEngine::WHITE_KNIGHT + color][lane]);
+
+    __m256i targets[16] = {
+        slide<-8>(orth, empty, all),  slide<8>(orth, empty, all),
+        slide<1>(orth, empty, notA),  slide<-1>(orth, empty, notH),
+        slide<-7>(diag, empty, notA), slide<-9>(diag, empty, notH),
+        slide<9>(diag, empty, notA),  slide<7>(diag, empty, notH),
+        step<-15>(knights, notA),  step<-17>(knights, notH),
+        step<-6>(knights, notAB),  step<-10>(knights, notGH),
+        step<10>(knights, notAB),  step<6>(knights, notGH),
+        step<17>(knights, notA),   step<15>(knights, notH),
+    };
+    __m256i total = _mm256_setzero_si256();
+    for (const __m256i& t : targets) total = _mm256_add_epi64(total, popcount64(_mm256_and_si256(t, area)));
+    return total;
+}
+
+#endif
+
+// Material + PST sums, piece counts and mobility for every lane
+void accumulate(Batch& b, const Weights& w, const BitboardEngine* positions, int n) {
+#if defined(__AVX2__)
+    (void)positions;
+    (void)n;
+    // Only squares some lane occupies are visited, which for positions from
+    // the same games is not many more than one position's pieces
+    __m256i psqt = _mm256_setzero_si256();
+    for (int piece = 0; piece < 12; piece++) {
+        const __m256i lo = load256(b.lo[piece]);
+        const __m256i hi = load256(b.hi[piece]);
+        __m256i count = _mm256_setzero_si256();
+        Bitboard occ = b.occupied[piece];
+        while (occ) {
+            int sq = __builtin_ctzll(occ);
+            // Shift the square's bit into the sign bit, then smear it across the lane
+            __m256i half = sq < 32 ? lo : hi;
+            __m256i mask = _mm256_srai_epi32(_mm256_sll_epi32(half, _mm_cvtsi32_si128(31 - (sq & 31))), 31);
+            psqt = _mm256_add_epi32(psqt, _mm256_and_si256(mask, _mm256_set1_epi32(w.psq[piece][sq])));
+            count = _mm256_sub_epi32(count, mask);
+            occ &= occ - 1;
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(b.count[piece]), count);
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i*>(b.psqt), psqt);
+
+    for (int lane = 0; lane < LANES; lane += 4) {
+        __m256i mobility = _mm256_sub_epi64(sideMobility(b, lane, 0), sideMobility(b, lane, 1));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(&b.mobility[lane]), mobility);
+    }
+#else
+    for (int lane = 0; lane < LANES; lane++) {
+        b.psqt[lane] = 0;
+        b.mobility[lane] = 0;
+    }
+    for (int piece = 0; piece < 12; piece++) {
+        for (int lane = 0; lane < LANES; lane++) {
+            Bitboard bb = b.pieces[piece][lane];
+            b.count[piece][lane] = __builtin_popcountll(bb);
+            while (bb) {
+                b.psqt[lane] += w.psq[piece][__builtin_ctzll(bb)];
+                bb &= bb - 1;
+            }
+        }
+    }
+    for (int lane = 0; lane < n; lane++) {
+        AttackInfo attacks;
+        computeAttacks(positions[lane], attacks);
+        b.mobility[lane] = attacks.mobility[0] - attacks.mobility[1];
+    }
+#endif
+}
+
+}
+
+void evaluateBatch(const BitboardEngine* positions, int n, int* out) {
+    Batch batch;
+    int start = 0;
+    while (start < n) {
+        // A chunk shares one weight set, since the PST values are broadcast to all lanes
+        const Weights& w = positions[start].getWeights();
+        int size = 1;
+        while (size < LANES && start + size < n && &positions[start + size].getWeights() == &w) size++;
+
+        load(batch, positions + start, size);
+        accumulate(batch, w, positions + start, size);
+
+        for (int lane = 0; lane < size; lane++) {
+            const BitboardEngine& eng = positions[start + lane];
+            uint64_t materialKey = 0;
+            for (int piece = 0; piece < 12; piece++) {
+                materialKey += batch.count[piece][lane] * Endgame::materialUnit(piece);
+            }
+
+            // Same steps as evaluateLazy() with an unbounded window
+            const MaterialEntry& material = materialTable().probe(materialKey, w);
+            if (material.endgame && material.endgame->evaluate) {
+                out[start + lane] = material.endgame->evaluate(eng, material.endgame->strong);
+                continue;
+            }
+            const PawnEntry& pawnInfo = pawnTable().probe(eng);
+            int mobility = static_cast<int>(batch.mobility[lane]);
+            Score score = batch.psqt[lane] + material.imbalance
+                        + makeScore(pawnInfo.mg + mobility * w.mobility[MG], pawnInfo.eg + mobility * w.mobility[EG]);
+            out[start + lane] = taperScore(eng, material, mgValue(score), egValue(score));
+        }
+        start += size;
+    }
+}
+
+}
@@ -0,0 +1,172 @@
+#include "Evaluation.h"
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+namespace Eval {
+
+namespace {
+
+const char BINARY_MAGIC[4] = { 'C', 'B', 'E', 'W' };
+const uint32_t BINARY_VERSION = 2;
+
+// Each loaded set gets its own pawn-hash id (splitmix64 of a counter, never 0)
+uint64_t nextWeightsId() {
+    static uint64_t counter = 0;
+    uint64_t z = (++counter) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return z ? z : 1;
+}
+
+// Stores name's values in the weight set. Names that aren't weights are
+// ignored; a wrong number of values is an error.
+bool applyConstant(Weights& w, const std::string& name, const std::vector<int>& values) {
+    static const char* TYPE_NAMES[6] = { "PAWN", "ROOK", "KNIGHT", "BISHOP", "QUEEN", "KING" };
+    auto expect = [&](size_t n) {
+        if (values.size() == n) return true;
+        std::cerr << "Weights: " << name << " has " << values.size() << " values, expected " << n << std::endl;
+        return false;
+    };
+
+    for (int type = 0; type < 6; type++) {
+        for (int phase = MG; phase <= EG; phase++) {
+            std::string prefix = phase == MG ? "MG_" : "EG_";
+            if (name == prefix + TYPE_NAMES[type] + "_VAL") {
+                if (!expect(1)) return false;
+                w.pieceValue[type][phase] = values[0];
+                return true;
+            }
+            if (name == prefix + TYPE_NAMES[type] + "_TABLE") {
+                if (!expect(64)) return false;
+                for (int sq = 0; sq < 64; sq++) w.pst[type][sq][phase] = values[sq];
+                return true;
+            }
+        }
+    }
+
+    int* pair = nullptr;
+    if (name == "DOUBLED_PAWN_PENALTY")       pair = w.doubledPawn;
+    else if (name == "ISOLATED_PAWN_PENALTY") pair = w.isolatedPawn;
+    else if (name == "BACKWARD_PAWN_PENALTY") pair = w.backwardPawn;
+    if (pair) {
+        if (!expect(1)) return false;
+        pair[MG] = pair[EG] = values[0];
+        return true;
+    }
+    if (name == "PASSED_PAWN_BONUS") {
+        if (!expect(8)) return false;
+        for (int i = 0; i < 8; i++) {
+            w.passedPawn[i][MG] = values[i] / 2;
+            w.passedPawn[i][EG] = values[i];
+        }
+        return true;
+    }
+
+    int* single = nullptr;
+    if (name == "MOBILITY_MG")         single = &w.mobility[MG];
+    else if (name == "MOBILITY_EG")    single = &w.mobility[EG];
+    else if (name == "BISHOP_PAIR_MG") single = &w.bishopPair[MG];
+    else if (name == "BISHOP_PAIR_EG") single = &w.bishopPair[EG];
+    if (single) {
+        if (!expect(1)) return false;
+        *single = values[0];
+        return true;
+    }
+    return true;  // phase weights and anything else: not tunable, ignored
+}
+
+// Text format: "... NAME = value;" and "... NAME[n] = { v, v, ... };" statements,
+// with // comments, as in Evaluation.h
+bool parseText(const std::string& text, Weights& w) {
+    std::string stripped;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t comment = line.find("//");
+        stripped += line.substr(0, comment) + "\n";
+    }
+
+    size_t start = 0;
+    size_t end;
+    while ((end = stripped.find(';', start)) != std::string::npos) {
+        std::string stmt = stripped.substr(start, end - start);
+        start = end + 1;
+        size_t eq = stmt.find('=');
+        if (eq == std::string::npos) continue;
+
+        // Name: the last identifier before '=' (ignoring any [n])
+        std::string lhs = stmt.substr(0, eq);
+        size_t bracket = lhs.find('[');
+        if (bracket != std::string::npos) lhs = lhs.substr(0, bracket);
+        size_t nameEnd = lhs.find_last_not_of(" \t\r\n");
+        if (nameEnd == std::string::npos) continue;
+        size_t nameStart = nameEnd;
+        while (nameStart > 0 && (std::isalnum((unsigned char)lhs[nameStart - 1]) || lhs[nameStart - 1] == '_')) {
+            nameStart--;
+        }
+        std::string name = lhs.substr(nameStart, nameEnd - nameStart + 1);
+
+        std::vector<int> values;
+        const char* p = stmt.c_str() + eq + 1;
+        while (*p) {
+            if (*p == '-' || std::isdigit((unsigned char)*p)) {
+                char* next;
+                values.push_back(static_cast<int>(std::strtol(p, &next, 10)));
+                p = next;
+            } else {
+                p++;
+            }
+        }
+        if (!applyConstant(w, name, values)) return false;
+    }
+    return true;
+}
+
+}
+
+bool loadWeights(const std::string& path, Weights& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Weights: cannot open '" << path << "'" << std::endl;
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    Weights w = DEFAULT_WEIGHTS;
+    if (data.size() >= sizeof(BINARY_MAGIC) && std::memcmp(data.data(), BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0) {
+        uint32_t version = 0;
+        if (data.size() == sizeof(BINARY_MAGIC) + sizeof(version) + sizeof(Weights)) {
+            std::memcpy(&version, data.data() + sizeof(BINARY_MAGIC), sizeof(version));
+        }
+        if (version != BINARY_VERSION) {
+            std::cerr << "Weights: '" << path << "' is not a compatible weights file" << std::endl;
+            return false;
+        }
+        std::memcpy(&w, data.data() + sizeof(BINARY_MAGIC) + sizeof(version), sizeof(Weights));
+    } else if (!parseText(data, w)) {
+        std::cerr << "Weights: could not parse '" << path << "'" << std::endl;
+        return false;
+    }
+
+    buildPsqTable(w);  // derived data is never trusted from the file
+    w.id = nextWeightsId();
+    out = w;
+    return true;
+}
+
+bool saveWeights(const std::string& path, const Weights& w) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    out.write(reinterpret_cast<const char*>(&BINARY_VERSION), sizeof(BINARY_VERSION));
+    out.write(reinterpret_cast<const char*>(&w), sizeof(Weights));
+    return static_cast<bool>(out);
+}
+
+}
@@ -694,6 +694,10 @@ void Game::restartGame() {
     moveValidator.clearEnPassantSquare();
     moveValidator.resetCastlingRights();
     
+    // Let bots discard search state from the finished game
+    if (whiteBot) whiteBot->newGame();
+    if (blackBot && blackBot != whiteBot) blackBot->newGame();
+    
     std::cout << "Game restarted. White to move" << std::endl;
     startTurnTimer();
 }
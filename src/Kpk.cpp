@@ -0,0 +1,126 @@
+#include "Kpk.h"
+#include "Attacks.h"
+#include <cstdint>
+#include <vector>
+
+namespace Kpk {
+
+namespace {
+
+// Positions are stored with white as the strong side and the pawn on files a-d:
+// white king, black king, side to move, pawn file and pawn row (1..6)
+constexpr int MAX_INDEX = 64 * 64 * 2 * 4 * 6;
+
+enum Result : uint8_t { INVALID = 0, UNKNOWN = 1, DRAW = 2, WIN = 4 };
+
+constexpr int WHITE = 0;
+constexpr int BLACK = 1;
+
+int index(int stm, int wk, int bk, int pawn) {
+    return wk | (bk << 6) | (stm << 12) | ((pawn % 8) << 13) | ((pawn / 8 - 1) << 15);
+}
+
+bool adjacent(int a, int b) { return (Attacks::kingAttacks(a) >> b) & 1; }
+
+// Position from its index, with the results that need no look-ahead
+Result initial(int idx, int& stm, int& wk, int& bk, int& pawn) {
+    wk = idx & 63;
+    bk = (idx >> 6) & 63;
+    stm = (idx >> 12) & 1;
+    pawn = ((idx >> 15) + 1) * 8 + ((idx >> 13) & 3);
+    int push = pawn - 8;  // white pawns move toward lower indices
+
+    if (wk == bk || adjacent(wk, bk) || wk == pawn || bk == pawn
+        || (stm == WHITE && (Attacks::pawnAttacks(WHITE, pawn) >> bk & 1))) {
+        return INVALID;
+    }
+    // Pawn on the 7th promotes safely
+    if (stm == WHITE && pawn / 8 == 1 && wk != push && bk != push
+        && (!adjacent(bk, push) || adjacent(wk, push))) {
+        return WIN;
+    }
+    if (stm == BLACK) {
+        Bitboard guarded = Attacks::kingAttacks(wk) | Attacks::pawnAttacks(WHITE, pawn);
+        // Stalemate, or the black king takes an undefended pawn
+        if (!(Attacks::kingAttacks(bk) & ~guarded) || (adjacent(bk, pawn) && !adjacent(wk, pawn))) {
+            return DRAW;
+        }
+    }
+    return UNKNOWN;
+}
+
+// One retrograde step: combine the results of every move. Moves into illegal
+// positions look up INVALID (0) and drop out of the OR.
+Result classify(const std::vector<uint8_t>& db, int stm, int wk, int bk, int pawn) {
+    int r = 0;
+    if (stm == WHITE) {
+        Bitboard moves = Attacks::kingAttacks(wk);
+        while (moves) {
+            r |= db[index(BLACK, __builtin_ctzll(moves), bk, pawn)];
+            moves &= moves - 1;
+        }
+        int push = pawn - 8;
+        if (pawn / 8 > 1) r |= db[index(BLACK, wk, bk, push)];  // 7th-rank pushes were settled in initial()
+        if (pawn / 8 == 6 && push != wk && push != bk) r |= db[index(BLACK, wk, bk, push - 8)];
+        return (r & WIN) ? WIN : (r & UNKNOWN) ? UNKNOWN : DRAW;
+    }
+    Bitboard moves = Attacks::kingAttacks(bk);
+    while (moves) {
+        r |= db[index(WHITE, wk, __builtin_ctzll(moves), pawn)];
+        moves &= moves - 1;
+    }
+    return (r & DRAW) ? DRAW : (r & UNKNOWN) ? UNKNOWN : WIN;
+}
+
+std::vector<uint32_t> generate() {
+    std::vector<uint8_t> db(MAX_INDEX);
+    for (int idx = 0; idx < MAX_INDEX; idx++) {
+        int stm, wk, bk, pawn;
+        db[idx] = initial(idx, stm, wk, bk, pawn);
+    }
+
+    // Iterate until nothing changes; whatever is still unknown is a draw
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int idx = 0; idx < MAX_INDEX; idx++) {
+            if (db[idx] != UNKNOWN) continue;
+            int stm, wk, bk, pawn;
+            initial(idx, stm, wk, bk, pawn);
+            Result r = classify(db, stm, wk, bk, pawn);
+            if (r != UNKNOWN) {
+                db[idx] = r;
+                changed = true;
+            }
+        }
+    }
+
+    std::vector<uint32_t> bits(MAX_INDEX / 32, 0);
+    for (int idx = 0; idx < MAX_INDEX; idx++) {
+        if (db[idx] == WIN) bits[idx / 32] |= 1u << (idx % 32);
+    }
+    return bits;
+}
+
+}
+
+bool probe(int strongKing, int pawn, int weakKing, int strongSide, int sideToMove) {
+    static const std::vector<uint32_t> bits = generate();
+
+    // Make the strong side white (flip ranks), then put the pawn on files a-d
+    int wk = strongKing, bk = weakKing, p = pawn;
+    if (strongSide == BLACK) {
+        wk ^= 56;
+        bk ^= 56;
+        p ^= 56;
+    }
+    if (p % 8 >= 4) {
+        wk ^= 7;
+        bk ^= 7;
+        p ^= 7;
+    }
+    int idx = index(sideToMove == strongSide ? WHITE : BLACK, wk, bk, p);
+    return (bits[idx / 32] >> (idx % 32)) & 1;
+}
+
+}
@@ -2,7 +2,9 @@
 #include <iostream>
 #include <cmath>
 #include <cstdint>
-#include "Game.h"
+#include <cctype>
+#include <cstring>
+#include "Zobrist.h"
 
 MoveValidator::MoveValidator(BitboardEngine* engine) 
     : engine(engine), lastEnPassantRow(-1), lastEnPassantCol(-1),
@@ -422,10 +424,16 @@ bool MoveValidator::executeMove(Move& move, int playerColor, bool skipValidation
 }
 
 std::vector<Move> MoveValidator::getValidMoves(int row, int col, int playerColor) {
-    std::vector<Move> moves;
+    Move buffer[MAX_PIECE_MOVES];
+    int count = getValidMoves(row, col, playerColor, buffer);
+    return std::vector<Move>(buffer, buffer + count);
+}
+
+int MoveValidator::getValidMoves(int row, int col, int playerColor, Move* out) {
+    int count = 0;
     
     int piece = getPieceAt(row, col);
-    if (piece == -1) return moves;  // No piece at this position
+    if (piece == -1) return 0;  // No piece at this position
     
     // Check all possible destination squares
     for (int r = 0; r < 8; r++) {
@@ -434,13 +442,12 @@ std::vector<Move> MoveValidator::getValidMoves(int row, int col, int playerColor
             
             // Check if this move is valid
             if (isValidMove(row, col, r, c, playerColor)) {
-                Move move(row, col, r, c);
-                moves.push_back(move);
+                out[count++] = Move(row, col, r, c);
             }
         }
     }
     
-    return moves;
+    return count;
 }
 
 bool MoveValidator::hasAnyLegalMoves(int playerColor) {
@@ -547,3 +554,331 @@ bool MoveValidator::canCastleKingside(int playerColor) const {
 bool MoveValidator::canCastleQueenside(int playerColor) const {
     return (playerColor == WHITE) ? whiteQueensideCastle : blackQueensideCastle;
 }
+
+uint64_t MoveValidator::getPositionKey(int sideToMove) const {
+    uint64_t key = engine->zobristKey;
+    if (sideToMove == BLACK) key ^= Zobrist::KEYS.side;
+    if (whiteKingsideCastle)  key ^= Zobrist::KEYS.castling[0];
+    if (whiteQueensideCastle) key ^= Zobrist::KEYS.castling[1];
+    if (blackKingsideCastle)  key ^= Zobrist::KEYS.castling[2];
+    if (blackQueensideCastle) key ^= Zobrist::KEYS.castling[3];
+    if (lastEnPassantCol != -1) key ^= Zobrist::KEYS.enPassant[lastEnPassantCol];
+    return key;
+}
+
+std::string MoveValidator::moveToString(const Move& move) {
+    std::string s = BitboardEngine::squareToAlgebraic(move.fromRow, move.fromCol)
+                  + BitboardEngine::squareToAlgebraic(move.toRow, move.toCol);
+    if (move.promotedTo != -1) {
+        s += static_cast<char>(BitboardEngine::getPieceChar(move.promotedTo) - 'A' + 'a');
+    }
+    return s;
+}
+
+std::string MoveValidator::moveToSan(const Move& move, int playerColor) {
+    int piece = getPieceAt(move.fromRow, move.fromCol);
+    if (piece == -1) return moveToString(move);
+    int type = piece / 2;
+
+    std::string san;
+    if (type == 5 && std::abs(move.toCol - move.fromCol) == 2) {
+        san = move.toCol == 6 ? "O-O" : "O-O-O";
+    } else {
+        bool capture = getPieceAt(move.toRow, move.toCol) != -1 || (type == 0 && move.fromCol != move.toCol);
+        if (type == 0) {
+            if (capture) san += static_cast<char>('a' + move.fromCol);
+        } else {
+            san += BitboardEngine::getPieceChar(piece);
+
+            // Disambiguate from other pieces of the same kind reaching the square
+            bool other = false, sameFile = false, sameRank = false;
+            Move moves[MAX_PIECE_MOVES];
+            for (int row = 0; row < 8; row++) {
+                for (int col = 0; col < 8; col++) {
+                    if ((row == move.fromRow && col == move.fromCol) || getPieceAt(row, col) != piece) continue;
+                    int n = getValidMoves(row, col, playerColor, moves);
+                    for (int i = 0; i < n; i++) {
+                        if (moves[i].toRow != move.toRow || moves[i].toCol != move.toCol) continue;
+                        other = true;
+                        sameFile |= col == move.fromCol;
+                        sameRank |= row == move.fromRow;
+                    }
+                }
+            }
+            if (other && (!sameFile || sameRank)) san += static_cast<char>('a' + move.fromCol);
+            if (other && sameFile) san += static_cast<char>('8' - move.fromRow);
+        }
+        if (capture) san += 'x';
+        san += BitboardEngine::squareToAlgebraic(move.toRow, move.toCol);
+        if (type == 0 && (move.toRow == 0 || move.toRow == 7)) {
+            san += '=';
+            san += move.promotedTo != -1 ? BitboardEngine::getPieceChar(move.promotedTo) : 'Q';
+        }
+    }
+
+    // Check or mate: play the move on the real position and put it back
+    BitboardEngine::EngineState engineState = engine->getState();
+    ValidatorState validatorState = getState();
+    Move played = move;
+    executeMove(played, playerColor, true);
+    int opponent = playerColor == WHITE ? BLACK : WHITE;
+    if (isKingInCheck(opponent)) san += hasAnyLegalMoves(opponent) ? '+' : '#';
+    engine->setState(engineState);
+    setState(validatorState);
+    return san;
+}
+
+bool MoveValidator::parseMove(const std::string& text, int playerColor, Move& out) {
+    std::string san = text;
+    while (!san.empty() && std::strchr("+#!?", san.back())) san.pop_back();
+    if (san.empty()) return false;
+
+    int pieceType = 0;               // piece / 2 of the mover (-1 = any)
+    int toRow = -1, toCol = -1;
+    int fromRow = -1, fromCol = -1;  // known parts of the origin
+    int promotion = -1;              // piece / 2, or -1
+
+    auto promotionType = [](char c) {
+        switch (std::toupper(static_cast<unsigned char>(c))) {
+            case 'Q': return 4;
+            case 'R': return 1;
+            case 'B': return 3;
+            case 'N': return 2;
+            default:  return -1;
+        }
+    };
+    auto isFile = [](char c) { return c >= 'a' && c <= 'h'; };
+    auto isRank = [](char c) { return c >= '1' && c <= '8'; };
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        pieceType = 5;
+        fromCol = 4;
+        fromRow = toRow = playerColor == WHITE ? 7 : 0;
+        toCol = san.size() == 3 ? 6 : 2;
+    } else if (san.size() >= 4 && isFile(san[0]) && isRank(san[1]) && isFile(san[2]) && isRank(san[3])
+               && (san.size() == 4 || (san.size() == 5 && promotionType(san[4]) >= 0))) {
+        // Coordinate notation (e2e4, e7e8q)
+        pieceType = -1;
+        fromCol = san[0] - 'a';
+        fromRow = '8' - san[1];
+        toCol = san[2] - 'a';
+        toRow = '8' - san[3];
+        if (san.size() == 5) promotion = promotionType(san[4]);
+    } else {
+        size_t start = 0;
+        static const char PIECES[] = "PRNBQK";
+        const char* letter = std::strchr(PIECES, san[0]);
+        if (letter) {
+            pieceType = static_cast<int>(letter - PIECES);
+            start = 1;
+        }
+        size_t eq = san.find('=');
+        if (eq != std::string::npos) {
+            if (eq + 1 >= san.size()) return false;
+            promotion = promotionType(san[eq + 1]);
+            san.erase(eq);
+        } else if (pieceType == 0 && san.size() > 2 && promotionType(san.back()) >= 0 && isRank(san[san.size() - 2])) {
+            promotion = promotionType(san.back());  // "e8Q"
+            san.pop_back();
+        }
+        if (san.size() < start + 2 || !isFile(san[san.size() - 2]) || !isRank(san.back())) return false;
+        toCol = san[san.size() - 2] - 'a';
+        toRow = '8' - san.back();
+        for (size_t i = start; i + 2 < san.size(); i++) {
+            if (isFile(san[i])) fromCol = san[i] - 'a';
+            else if (isRank(san[i])) fromRow = '8' - san[i];
+            else if (san[i] != 'x' && san[i] != '-' && san[i] != ':') return false;
+        }
+    }
+
+    int found = 0;
+    Move moves[MAX_PIECE_MOVES];
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            int piece = getPieceAt(row, col);
+            if (piece == -1 || piece % 2 != playerColor) continue;
+            if ((pieceType >= 0 && piece / 2 != pieceType) || (fromRow >= 0 && row != fromRow) || (fromCol >= 0 && col != fromCol)) continue;
+            int n = getValidMoves(row, col, playerColor, moves);
+            for (int i = 0; i < n; i++) {
+                if (moves[i].toRow != toRow || moves[i].toCol != toCol) continue;
+                bool promotes = piece / 2 == 0 && (toRow == 0 || toRow == 7);
+                if (!promotes && promotion >= 0) continue;
+                out = moves[i];
+                if (promotes) out.promotedTo = (promotion >= 0 ? promotion : 4) * 2 + playerColor;
+                found++;
+            }
+        }
+    }
+    return found == 1;
+}
+
+namespace {
+
+// Next whitespace-separated field of text from pos (left just past it); empty at the end
+std::string nextField(const std::string& text, size_t& pos) {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    size_t start = pos;
+    while (pos < text.size() && !std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    return text.substr(start, pos - start);
+}
+
+bool parseCount(const std::string& field, int& out) {
+    if (field.empty() || field.size() > 6) return false;
+    int value = 0;
+    for (char c : field) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    out = value;
+    return true;
+}
+
+}
+
+bool MoveValidator::setPosition(const std::string& placement, const std::string& side,
+                                const std::string& castling, const std::string& enPassant, int& sideToMove) {
+    if (side != "w" && side != "b") return false;
+    int color = side == "w" ? WHITE : BLACK;
+
+    bool rights[4] = { false, false, false, false };  // K Q k q
+    if (castling != "-") {
+        if (castling.empty()) return false;
+        static const char LETTERS[] = "KQkq";
+        for (char c : castling) {
+            const char* found = c ? std::strchr(LETTERS, c) : nullptr;
+            if (!found) return false;
+            rights[found - LETTERS] = true;
+        }
+    }
+
+    int epRow = -1, epCol = -1;
+    if (enPassant != "-") {
+        // The square passed over by the double push of the side that just moved
+        char rank = color == WHITE ? '6' : '3';
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || enPassant[1] != rank) return false;
+        epCol = enPassant[0] - 'a';
+        epRow = '8' - rank;
+    }
+
+    if (!engine->loadPlacement(placement)) return false;
+
+    // Drop rights the placement can't support (a king or rook off its home square)
+    auto at = [this](int row, int col, int piece) { return engine->getPieceAt(row, col) == piece; };
+    bool whiteKing = at(7, 4, BitboardEngine::WHITE_KING), blackKing = at(0, 4, BitboardEngine::BLACK_KING);
+    whiteKingsideCastle  = rights[0] && whiteKing && at(7, 7, BitboardEngine::WHITE_ROOK);
+    whiteQueensideCastle = rights[1] && whiteKing && at(7, 0, BitboardEngine::WHITE_ROOK);
+    blackKingsideCastle  = rights[2] && blackKing && at(0, 7, BitboardEngine::BLACK_ROOK);
+    blackQueensideCastle = rights[3] && blackKing && at(0, 0, BitboardEngine::BLACK_ROOK);
+    lastEnPassantRow = epRow;
+    lastEnPassantCol = epCol;
+    sideToMove = color;
+    return true;
+}
+
+bool MoveValidator::loadFen(const std::string& fen, FenState& state) {
+    size_t pos = 0;
+    std::string placement = nextField(fen, pos);
+    std::string side = nextField(fen, pos);
+    std::string castling = nextField(fen, pos);
+    std::string enPassant = nextField(fen, pos);
+    std::string halfmove = nextField(fen, pos);
+    std::string fullmove = nextField(fen, pos);
+
+    FenState parsed;
+    if ((!halfmove.empty() && !parseCount(halfmove, parsed.halfmoveClock))
+        || (!fullmove.empty() && !parseCount(fullmove, parsed.fullmoveNumber))
+        || !nextField(fen, pos).empty()) {
+        return false;
+    }
+    if (parsed.fullmoveNumber < 1) parsed.fullmoveNumber = 1;
+    if (!setPosition(placement, side, castling, enPassant, parsed.sideToMove)) return false;
+    state = parsed;
+    return true;
+}
+
+bool MoveValidator::loadEpd(const std::string& epd, FenState& state, std::vector<EpdOperation>* operations) {
+    size_t pos = 0;
+    std::string placement = nextField(epd, pos);
+    std::string side = nextField(epd, pos);
+    std::string castling = nextField(epd, pos);
+    std::string enPassant = nextField(epd, pos);
+
+    std::vector<EpdOperation> parsedOps;
+    if (!parseEpdOperations(epd.substr(pos), parsedOps)) return false;
+    FenState parsed;
+    for (const EpdOperation& op : parsedOps) {
+        if (op.operands.size() != 1) continue;
+        if (op.opcode == "hmvc") parseCount(op.operands[0], parsed.halfmoveClock);
+        else if (op.opcode == "fmvn" && parseCount(op.operands[0], parsed.fullmoveNumber) && parsed.fullmoveNumber < 1) parsed.fullmoveNumber = 1;
+    }
+
+    if (!setPosition(placement, side, castling, enPassant, parsed.sideToMove)) return false;
+    state = parsed;
+    if (operations) operations->insert(operations->end(), parsedOps.begin(), parsedOps.end());
+    return true;
+}
+
+bool MoveValidator::parseEpdOperations(const std::string& text, std::vector<EpdOperation>& operations) {
+    size_t pos = 0, n = text.size();
+    auto skipSpace = [&]() {
+        while (pos < n && std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    };
+    while (true) {
+        skipSpace();
+        if (pos >= n) return true;
+        EpdOperation op;
+        while (pos < n && text[pos] != ';' && !std::isspace(static_cast<unsigned char>(text[pos]))) op.opcode += text[pos++];
+        while (true) {
+            skipSpace();
+            if (pos >= n) break;  // tolerate a missing final semicolon
+            if (text[pos] == ';') {
+                pos++;
+                break;
+            }
+            std::string operand;
+            if (text[pos] == '"') {
+                size_t close = text.find('"', pos + 1);
+                if (close == std::string::npos) return false;
+                operand = text.substr(pos + 1, close - pos - 1);
+                pos = close + 1;
+            } else {
+                while (pos < n && text[pos] != ';' && !std::isspace(static_cast<unsigned char>(text[pos]))) operand += text[pos++];
+            }
+            op.operands.push_back(std::move(operand));
+        }
+        if (!op.opcode.empty()) operations.push_back(std::move(op));
+    }
+}
+
+std::string MoveValidator::toFen(const FenState& state) const {
+    return toEpd(state.sideToMove) + ' ' + std::to_string(state.halfmoveClock) + ' ' + std::to_string(state.fullmoveNumber);
+}
+
+std::string MoveValidator::toEpd(int sideToMove, const std::vector<EpdOperation>& operations) const {
+    std::string epd = engine->placementFen();
+    epd += sideToMove == WHITE ? " w " : " b ";
+    size_t castlingStart = epd.size();
+    if (whiteKingsideCastle)  epd += 'K';
+    if (whiteQueensideCastle) epd += 'Q';
+    if (blackKingsideCastle)  epd += 'k';
+    if (blackQueensideCastle) epd += 'q';
+    if (epd.size() == castlingStart) epd += '-';
+    epd += ' ';
+    epd += lastEnPassantCol != -1 ? BitboardEngine::squareToAlgebraic(lastEnPassantRow, lastEnPassantCol) : "-";
+
+    for (const EpdOperation& op : operations) {
+        epd += ' ';
+        epd += op.opcode;
+        // Quote strings (id, comments c0..c9, anything with spaces)
+        bool text = op.opcode == "id" || (op.opcode.size() == 2 && op.opcode[0] == 'c' && std::isdigit(static_cast<unsigned char>(op.opcode[1])));
+        for (const std::string& operand : op.operands) {
+            bool quote = text || operand.empty() || operand.find_first_of(" \t;") != std::string::npos;
+            epd += ' ';
+            if (quote) epd += '"';
+            epd += operand;
+            if (quote) epd += '"';
+        }
+        epd += ';';
+    }
+    return epd;
+}
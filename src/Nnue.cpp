@@ -0,0 +1,297 @@
+#include "Nnue.h"
+#include "BitboardEngine.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace Nnue {
+
+namespace {
+
+struct Network {
+    const int16_t* ftBias = nullptr;
+    const int16_t* ftWeights = nullptr;
+    const int32_t* h1Bias = nullptr;
+    const int8_t*  h1Weights = nullptr;
+    const int32_t* h2Bias = nullptr;
+    const int8_t*  h2Weights = nullptr;
+    const int32_t* outBias = nullptr;
+    const int8_t*  outWeights = nullptr;
+};
+
+Network net;
+uint32_t generation = 0;    // bumped on every load; 0 = nothing loaded yet
+
+const void* mapping = nullptr;
+size_t mappingSize = 0;
+#if defined(_WIN32)
+HANDLE fileHandle = INVALID_HANDLE_VALUE;
+HANDLE mapHandle = nullptr;
+#endif
+
+constexpr size_t HEADER_SIZE = 64;
+
+constexpr size_t expectedFileSize() {
+    return HEADER_SIZE
+         + sizeof(int16_t) * L1 + sizeof(int16_t) * size_t(INPUTS) * L1
+         + sizeof(int32_t) * L2 + sizeof(int8_t) * L2 * 2 * L1
+         + sizeof(int32_t) * L3 + sizeof(int8_t) * L3 * L2
+         + sizeof(int32_t)      + sizeof(int8_t) * L3;
+}
+
+const void* mapFile(const std::string& path, size_t& size) {
+#if defined(_WIN32)
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) return nullptr;
+    size = static_cast<size_t>(fileSize.QuadPart);
+    mapHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapHandle) return nullptr;
+    return MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return nullptr; }
+    size = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // the mapping keeps the file alive
+    return p == MAP_FAILED ? nullptr : p;
+#endif
+}
+
+void unmapFile() {
+#if defined(_WIN32)
+    if (mapping) UnmapViewOfFile(mapping);
+    if (mapHandle) CloseHandle(mapHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+    mapHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (mapping) munmap(const_cast<void*>(mapping), mappingSize);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+// Feature index of piece on index as seen from perspective, whose king is on kingSq
+inline int featureIndex(int perspective, int kingSq, int piece, int index) {
+    if (perspective == 1) {
+        kingSq ^= 56;
+        index ^= 56;
+    }
+    int kind = (piece / 2) * 2 + ((piece % 2) != perspective);
+    return (kingSq * PIECE_KINDS + kind) * 64 + index;
+}
+
+// acc += (or -=) one first-layer weight column
+template <bool Add>
+inline void updateColumn(int16_t* acc, int feature) {
+    const int16_t* w = net.ftWeights + size_t(feature) * L1;
+#if defined(__AVX2__)
+    for (int i = 0; i < L1; i += 16) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+        a = Add ? _mm256_add_epi16(a, b) : _mm256_sub_epi16(a, b);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), a);
+    }
+#elif defined(__SSE4_1__)
+    for (int i = 0; i < L1; i += 8) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i));
+        a = Add ? _mm_add_epi16(a, b) : _mm_sub_epi16(a, b);
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), a);
+    }
+#else
+    for (int i = 0; i < L1; i++) acc[i] = static_cast<int16_t>(Add ? acc[i] + w[i] : acc[i] - w[i]);
+#endif
+}
+
+// Dot product of n clipped activations (0..127) with int8 weights; n is a multiple of 32
+inline int32_t dot(const uint8_t* in, const int8_t* w, int n) {
+#if defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+        // 127 * 128 * 2 fits int16, so maddubs cannot saturate here
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(a, b), ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+#elif defined(__SSE4_1__)
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(a, b), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++) sum += int32_t(in[i]) * int32_t(w[i]);
+    return sum;
+#endif
+}
+
+// Fully connected layer followed by the shift and clipped ReLU
+inline void hiddenLayer(const uint8_t* in, int inSize, const int8_t* weights,
+                        const int32_t* bias, uint8_t* out, int outSize) {
+    for (int o = 0; o < outSize; o++) {
+        int32_t v = bias[o] + dot(in, weights + size_t(o) * inSize, inSize);
+        out[o] = static_cast<uint8_t>(std::clamp(v >> HIDDEN_SHIFT, 0, 127));
+    }
+}
+
+void refresh(Accumulator& acc, const BitboardEngine& eng, int perspective) {
+    int16_t* values = acc.values[perspective];
+    std::memcpy(values, net.ftBias, sizeof(int16_t) * L1);
+
+    int kingSq = __builtin_ctzll(eng.kings[perspective]);
+    const Bitboard* sets[5] = { eng.pawns, eng.rooks, eng.knights, eng.bishops, eng.queens };
+    for (int type = 0; type < 5; type++) {
+        for (int color = 0; color < 2; color++) {
+            Bitboard bb = sets[type][color];
+            while (bb) {
+                int index = __builtin_ctzll(bb);
+                updateColumn<true>(values, featureIndex(perspective, kingSq, type * 2 + color, index));
+                bb &= bb - 1;
+            }
+        }
+    }
+    acc.dirty[perspective] = false;
+}
+
+template <bool Add>
+void pieceChanged(Accumulator& acc, const BitboardEngine& eng, int piece, int index) {
+    if (acc.generation != generation) {
+        acc.generation = generation;
+        acc.dirty[0] = acc.dirty[1] = true;
+    }
+    // A king move changes every feature of its own perspective
+    if (piece / 2 == 5) {
+        acc.dirty[piece % 2] = true;
+        return;
+    }
+    for (int perspective = 0; perspective < 2; perspective++) {
+        if (acc.dirty[perspective]) continue;
+        if (!eng.kings[perspective]) { acc.dirty[perspective] = true; continue; }
+        int kingSq = __builtin_ctzll(eng.kings[perspective]);
+        updateColumn<Add>(acc.values[perspective], featureIndex(perspective, kingSq, piece, index));
+    }
+}
+
+}
+
+bool load(const std::string& path) {
+    unload();
+
+    size_t size = 0;
+    const void* data = mapFile(path, size);
+    if (!data) {
+        std::cerr << "NNUE: cannot map '" << path << "'" << std::endl;
+        unmapFile();
+        return false;
+    }
+    mapping = data;
+    mappingSize = size;
+
+    const char* p = static_cast<const char*>(data);
+    uint32_t header[5] = {};  // version, inputs, l1, l2, l3
+    if (size >= HEADER_SIZE) std::memcpy(header, p + 4, sizeof(header));
+    if (size != expectedFileSize() || std::memcmp(p, "CBNN", 4) != 0 ||
+        header[0] != FILE_VERSION || header[1] != uint32_t(INPUTS) ||
+        header[2] != uint32_t(L1) || header[3] != uint32_t(L2) || header[4] != uint32_t(L3)) {
+        std::cerr << "NNUE: '" << path << "' is not a compatible network file" << std::endl;
+        unmapFile();
+        return false;
+    }
+
+    p += HEADER_SIZE;
+    auto take = [&p](size_t bytes) { const char* at = p; p += bytes; return at; };
+    net.ftBias     = reinterpret_cast<const int16_t*>(take(sizeof(int16_t) * L1));
+    net.ftWeights  = reinterpret_cast<const int16_t*>(take(sizeof(int16_t) * size_t(INPUTS) * L1));
+    net.h1Bias     = reinterpret_cast<const int32_t*>(take(sizeof(int32_t) * L2));
+    net.h1Weights  = reinterpret_cast<const int8_t*>(take(L2 * 2 * L1));
+    net.h2Bias     = reinterpret_cast<const int32_t*>(take(sizeof(int32_t) * L3));
+    net.h2Weights  = reinterpret_cast<const int8_t*>(take(L3 * L2));
+    net.outBias    = reinterpret_cast<const int32_t*>(take(sizeof(int32_t)));
+    net.outWeights = reinterpret_cast<const int8_t*>(take(L3));
+
+    generation++;
+    return true;
+}
+
+void unload() {
+    unmapFile();
+    net = Network{};
+}
+
+bool isLoaded() { return mapping != nullptr; }
+
+const char* simdName() {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE4_1__)
+    return "sse4.1";
+#else
+    return "scalar";
+#endif
+}
+
+void pieceAdded(Accumulator& acc, const BitboardEngine& eng, int piece, int index) {
+    pieceChanged<true>(acc, eng, piece, index);
+}
+
+void pieceRemoved(Accumulator& acc, const BitboardEngine& eng, int piece, int index) {
+    pieceChanged<false>(acc, eng, piece, index);
+}
+
+int evaluate(const BitboardEngine& eng) {
+    Accumulator& acc = eng.nnueAcc;
+    if (acc.generation != generation) {
+        acc.generation = generation;
+        acc.dirty[0] = acc.dirty[1] = true;
+    }
+    for (int perspective = 0; perspective < 2; perspective++) {
+        if (acc.dirty[perspective] && eng.kings[perspective]) refresh(acc, eng, perspective);
+    }
+
+    alignas(32) uint8_t input[2 * L1];
+    for (int perspective = 0; perspective < 2; perspective++) {
+        for (int i = 0; i < L1; i++) {
+            input[perspective * L1 + i] = static_cast<uint8_t>(std::clamp<int>(acc.values[perspective][i], 0, 127));
+        }
+    }
+
+    alignas(32) uint8_t hidden1[L2];
+    alignas(32) uint8_t hidden2[L3];
+    hiddenLayer(input, 2 * L1, net.h1Weights, net.h1Bias, hidden1, L2);
+    hiddenLayer(hidden1, L2, net.h2Weights, net.h2Bias, hidden2, L3);
+
+    int32_t out = *net.outBias + dot(hidden2, net.outWeights, L3);
+    return out / OUTPUT_SCALE;
+}
+
+}
@@ -0,0 +1,318 @@
+#include "Tablebase.h"
+#include "Endgame.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Tablebase {
+
+namespace {
+
+constexpr size_t HEADER_SIZE = 64;
+constexpr size_t NAME_SIZE = 16;
+
+// Piece letters in slot order within a side, with their piece constant for white
+constexpr char ORDER_CHARS[5] = { 'Q', 'R', 'B', 'N', 'P' };
+constexpr int ORDER_PIECES[5] = { BitboardEngine::WHITE_QUEEN, BitboardEngine::WHITE_ROOK, BitboardEngine::WHITE_BISHOP,
+                                  BitboardEngine::WHITE_KNIGHT, BitboardEngine::WHITE_PAWN };
+
+// White king squares of the pawnless index: a1-d1-d4 triangle (rank <= file)
+struct KingTables {
+    int square[10];
+    int index[64];
+};
+
+constexpr KingTables buildKingTables() {
+    KingTables t{};
+    int n = 0;
+    for (int sq = 0; sq < 64; sq++) {
+        int rank = 7 - sq / 8, file = sq % 8;
+        t.index[sq] = (file < 4 && rank <= file) ? n : -1;
+        if (t.index[sq] >= 0) t.square[n++] = sq;
+    }
+    return t;
+}
+
+constexpr KingTables KING_TABLES = buildKingTables();
+
+// Reflect in the a1-h8 diagonal (swap rank and file)
+constexpr int transpose(int sq) { return (7 - sq % 8) * 8 + (7 - sq / 8); }
+
+int kingStates(const Layout& layout) { return layout.hasPawns ? 32 : 10; }
+
+struct Table {
+    Layout layout;
+    const uint8_t* data = nullptr;
+    const void* mapping = nullptr;
+    size_t mappingSize = 0;
+#if defined(_WIN32)
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mapHandle = nullptr;
+#endif
+};
+
+std::vector<Table> tables;
+std::unordered_map<uint64_t, size_t> byKey;  // material key -> tables index
+int largest = 0;
+
+bool mapFile(const std::string& path, Table& t) {
+#if defined(_WIN32)
+    t.fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (t.fileHandle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(t.fileHandle, &fileSize)) return false;
+    t.mappingSize = static_cast<size_t>(fileSize.QuadPart);
+    t.mapHandle = CreateFileMappingA(t.fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!t.mapHandle) return false;
+    t.mapping = MapViewOfFile(t.mapHandle, FILE_MAP_READ, 0, 0, 0);
+    return t.mapping != nullptr;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return false; }
+    t.mappingSize = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, t.mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // the mapping keeps the file alive
+    if (p == MAP_FAILED) return false;
+    t.mapping = p;
+    return true;
+#endif
+}
+
+void unmapFile(Table& t) {
+#if defined(_WIN32)
+    if (t.mapping) UnmapViewOfFile(t.mapping);
+    if (t.mapHandle) CloseHandle(t.mapHandle);
+    if (t.fileHandle != INVALID_HANDLE_VALUE) CloseHandle(t.fileHandle);
+    t.mapHandle = nullptr;
+    t.fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (t.mapping && t.mappingSize) munmap(const_cast<void*>(t.mapping), t.mappingSize);
+#endif
+    t.mapping = nullptr;
+    t.mappingSize = 0;
+}
+
+void unloadAll() {
+    for (Table& t : tables) unmapFile(t);
+    tables.clear();
+    byKey.clear();
+    largest = 0;
+}
+
+// Map one file and check its header against the layout its name describes
+bool loadTable(const std::string& path, const std::string& name, Table& t) {
+    if (!parseLayout(name, t.layout)) {
+        std::cerr << "Tablebase: '" << path << "' is not named after a material signature" << std::endl;
+        return false;
+    }
+    if (!mapFile(path, t)) {
+        std::cerr << "Tablebase: cannot map '" << path << "'" << std::endl;
+        return false;
+    }
+
+    const char* p = static_cast<const char*>(t.mapping);
+    uint32_t version = 0;
+    uint64_t materialKey = 0, entries = 0;
+    if (t.mappingSize >= HEADER_SIZE) {
+        std::memcpy(&version, p + 4, sizeof(version));
+        std::memcpy(&materialKey, p + 8, sizeof(materialKey));
+        std::memcpy(&entries, p + 16, sizeof(entries));
+    }
+    if (t.mappingSize != HEADER_SIZE + t.layout.size || std::memcmp(p, "CBTB", 4) != 0
+        || version != FILE_VERSION || materialKey != t.layout.materialKey || entries != t.layout.size) {
+        std::cerr << "Tablebase: '" << path << "' is not a compatible table" << std::endl;
+        return false;
+    }
+    t.data = reinterpret_cast<const uint8_t*>(p + HEADER_SIZE);
+    return true;
+}
+
+}
+
+bool parseLayout(const std::string& name, Layout& out) {
+    size_t split = name.find('K', 1);
+    if (name.empty() || name[0] != 'K' || split == std::string::npos) return false;
+
+    Layout layout;
+    layout.name = name;
+    layout.count = 2;
+    layout.pieces[0] = BitboardEngine::WHITE_KING;
+    layout.pieces[1] = BitboardEngine::BLACK_KING;
+    const std::string sides[2] = { name.substr(1, split - 1), name.substr(split + 1) };
+    for (int color = 0; color < 2; color++) {
+        size_t used = 0;
+        for (int kind = 0; kind < 5; kind++) {
+            for (char c : sides[color]) {
+                if (c != ORDER_CHARS[kind]) continue;
+                if (layout.count == MAX_PIECES) return false;
+                layout.pieces[layout.count++] = ORDER_PIECES[kind] + color;
+                used++;
+            }
+        }
+        if (used != sides[color].size()) return false;  // unknown letter or a third king
+    }
+
+    for (int s = 0; s < layout.count; s++) {
+        layout.materialKey += Endgame::materialUnit(layout.pieces[s]);
+        if (layout.pieces[s] / 2 == 0) layout.hasPawns = true;
+    }
+    layout.size = 2 * static_cast<uint64_t>(kingStates(layout));
+    for (int s = 1; s < layout.count; s++) layout.size *= 64;
+    out = layout;
+    return true;
+}
+
+std::string nameOf(uint64_t materialKey) {
+    std::string name;
+    for (int color = 0; color < 2; color++) {
+        name += 'K';
+        for (int kind = 0; kind < 5; kind++) {
+            name.append(Endgame::pieceCount(materialKey, ORDER_PIECES[kind] + color), ORDER_CHARS[kind]);
+        }
+    }
+    return name;
+}
+
+uint64_t flipMaterialKey(uint64_t materialKey) {
+    constexpr uint64_t WHITE_NIBBLES = 0x0F0F0F0F0F0FULL;
+    return ((materialKey & WHITE_NIBBLES) << 4) | ((materialKey >> 4) & WHITE_NIBBLES);
+}
+
+uint64_t encode(const Layout& layout, const PieceSquare* pieces, int sideToMove) {
+    // Put each piece in the first free slot of its kind
+    int squares[MAX_PIECES];
+    unsigned taken = 0;
+    for (int s = 0; s < layout.count; s++) {
+        for (int i = 0; i < layout.count; i++) {
+            if (!(taken >> i & 1) && pieces[i].piece == layout.pieces[s]) {
+                squares[s] = pieces[i].square;
+                taken |= 1u << i;
+                break;
+            }
+        }
+    }
+
+    // Symmetry that brings the white king into its canonical region
+    int wk = squares[0];
+    int flip = wk % 8 >= 4 ? 7 : 0;
+    if (!layout.hasPawns && wk / 8 < 4) flip ^= 56;
+    wk ^= flip;
+    bool swap = !layout.hasPawns && 7 - wk / 8 > wk % 8;
+    if (swap) wk = transpose(wk);
+
+    uint64_t index = sideToMove * kingStates(layout)
+                   + (layout.hasPawns ? (wk / 8) * 4 + wk % 8 : KING_TABLES.index[wk]);
+    for (int s = 1; s < layout.count; s++) {
+        int sq = squares[s] ^ flip;
+        index = index * 64 + (swap ? transpose(sq) : sq);
+    }
+    return index;
+}
+
+void decode(const Layout& layout, uint64_t index, int* squares, int& sideToMove) {
+    for (int s = layout.count - 1; s >= 1; s--) {
+        squares[s] = static_cast<int>(index % 64);
+        index /= 64;
+    }
+    int states = kingStates(layout);
+    int wk = static_cast<int>(index % states);
+    sideToMove = static_cast<int>(index / states);
+    squares[0] = layout.hasPawns ? (wk / 4) * 8 + wk % 4 : KING_TABLES.square[wk];
+}
+
+bool save(const std::string& path, const Layout& layout, const std::vector<uint8_t>& values) {
+    char header[HEADER_SIZE] = {};
+    std::memcpy(header, "CBTB", 4);
+    std::memcpy(header + 4, &FILE_VERSION, sizeof(FILE_VERSION));
+    std::memcpy(header + 8, &layout.materialKey, sizeof(layout.materialKey));
+    std::memcpy(header + 16, &layout.size, sizeof(layout.size));
+    std::strncpy(header + 24, layout.name.c_str(), NAME_SIZE - 1);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out.write(header, HEADER_SIZE);
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size()));
+    return static_cast<bool>(out);
+}
+
+int init(const std::string& dir) {
+    unloadAll();
+
+    std::error_code ec;
+    std::filesystem::directory_iterator it(dir, ec);
+    if (ec) {
+        std::cerr << "Tablebase: cannot open directory '" << dir << "'" << std::endl;
+        return 0;
+    }
+    tables.reserve(64);
+    for (const auto& file : it) {
+        if (file.path().extension() != ".tb") continue;
+        Table t;
+        if (!loadTable(file.path().string(), file.path().stem().string(), t)) {
+            unmapFile(t);
+            continue;
+        }
+        if (byKey.count(t.layout.materialKey)) {
+            unmapFile(t);
+            continue;
+        }
+        byKey[t.layout.materialKey] = tables.size();
+        largest = std::max(largest, t.layout.count);
+        tables.push_back(t);
+    }
+    return static_cast<int>(tables.size());
+}
+
+int maxPieces() { return largest; }
+
+bool probe(const BitboardEngine& eng, int sideToMove, uint8_t& value) {
+    static const uint64_t KK_KEY = Endgame::materialUnit(BitboardEngine::WHITE_KING)
+                                 + Endgame::materialUnit(BitboardEngine::BLACK_KING);
+    if (eng.materialKey == KK_KEY) {
+        value = DRAW;
+        return true;
+    }
+
+    // Tables exist for one colour assignment; the other probes with colours
+    // swapped and the board flipped vertically
+    bool flipped = false;
+    auto found = byKey.find(eng.materialKey);
+    if (found == byKey.end()) {
+        found = byKey.find(flipMaterialKey(eng.materialKey));
+        if (found == byKey.end()) return false;
+        flipped = true;
+    }
+    const Table& t = tables[found->second];
+
+    const Bitboard* sets[6] = { eng.pawns, eng.rooks, eng.knights, eng.bishops, eng.queens, eng.kings };
+    PieceSquare pieces[MAX_PIECES];
+    int n = 0;
+    for (int piece = 0; piece < 12; piece++) {
+        Bitboard bb = sets[piece / 2][piece % 2];
+        while (bb) {
+            int sq = __builtin_ctzll(bb);
+            pieces[n++] = flipped ? PieceSquare{ piece ^ 1, sq ^ 56 } : PieceSquare{ piece, sq };
+            bb &= bb - 1;
+        }
+    }
+
+    value = t.data[encode(t.layout, pieces, flipped ? sideToMove ^ 1 : sideToMove)];
+    return value != ILLEGAL;
+}
+
+}
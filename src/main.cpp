@@ -1,3 +1,4 @@
+#include "Analysis.h"
 #include "Game.h"
 #include "GameConfig.h"
 #include "RandomBot.h"
@@ -17,6 +18,12 @@ int main(int argc, char* argv[]) {
         return config.helpRequested ? 0 : 1;
     }
 
+    // ---- bench mode: fixed search of built-in positions, before any option
+    // (network, weights, book, tablebases) can change what the search does ----
+    if (config.benchDepth > 0) {
+        return Analysis::bench(config.benchDepth, config.benchBotv2);
+    }
+
     // =================== Bot selection =====================
     Botv1 botv1;
     Botv2 botv2;
@@ -27,10 +34,68 @@ int main(int argc, char* argv[]) {
     ChessBot* botB = &botv2;  // Bot B (opponent in bvb / test-bots)
     // ========================================================================
 
-    // Apply --depth override if specified
-    if (config.depth > 0) {
-        botA->setMaxDepth(config.depth);
-        botB->setMaxDepth(config.depth);
+    // Apply --depth override if specified. A node or time budget without an
+    // explicit depth lets the bots keep deepening until the budget runs out.
+    int searchDepth = config.depth;
+    if (searchDepth < 1 && (config.nodes > 0 || config.moveTimeMs > 0)) searchDepth = 64;
+    if (searchDepth > 0) {
+        botA->setMaxDepth(searchDepth);
+        botB->setMaxDepth(searchDepth);
+    }
+    botA->setNodeLimit(config.nodes);
+    botB->setNodeLimit(config.nodes);
+    botA->setTimeLimit(config.moveTimeMs);
+    botB->setTimeLimit(config.moveTimeMs);
+    if (config.threads > 0) omp_set_num_threads(config.threads);
+    if (config.seedSpecified) {
+        botA->setSeed(config.seed);
+        botB->setSeed(config.seed + 1);
+    }
+    botv3.setMultiPV(config.multiPV);
+
+    // Optional neural evaluation for bot A (bot B stays on PeSTO as the reference)
+    bool useNnue = false;
+    if (!config.nnueFile.empty()) {
+        if (!Nnue::load(config.nnueFile)) return 1;
+        std::cout << "NNUE: loaded " << config.nnueFile << " (" << Nnue::simdName() << ")" << std::endl;
+        useNnue = true;
+    }
+    botA->setUseNnue(useNnue);
+
+    // Optional opening book (read-only mapping shared by every thread's Botv3)
+    if (!config.bookFile.empty()) {
+        if (!Book::load(config.bookFile)) return 1;
+        std::cout << "Book: loaded " << config.bookFile << std::endl;
+    }
+
+    // Optional endgame tablebases (probed by Botv3)
+    if (!config.tablebaseDir.empty()) {
+        int loaded = Tablebase::init(config.tablebaseDir);
+        if (loaded == 0) {
+            std::cerr << "Tablebase: no tables found in '" << config.tablebaseDir << "'" << std::endl;
+            return 1;
+        }
+        std::cout << "Tablebase: " << loaded << " tables, up to " << Tablebase::maxPieces() << " pieces" << std::endl;
+    }
+
+    // Optional runtime eval weights (shared read-only by every thread's bots)
+    Eval::Weights weightsA, weightsB;
+    const Eval::Weights* botAWeights = nullptr;
+    const Eval::Weights* botBWeights = nullptr;
+    if (!config.weightsFileA.empty()) {
+        if (!Eval::loadWeights(config.weightsFileA, weightsA)) return 1;
+        botAWeights = &weightsA;
+    }
+    if (!config.weightsFileB.empty()) {
+        if (!Eval::loadWeights(config.weightsFileB, weightsB)) return 1;
+        botBWeights = &weightsB;
+    }
+    botA->setEvalWeights(botAWeights);
+    botB->setEvalWeights(botBWeights);
+
+    // ---- analyze-epd mode: search a suite of positions, no game ----
+    if (!config.analyzeEpdFile.empty()) {
+        return Analysis::analyzeEpd(config, searchDepth, useNnue, botAWeights);
     }
 
     // Silence cout if --silent (for single-game mode)
@@ -57,19 +122,45 @@ int main(int argc, char* argv[]) {
             ChessBot* threadBotA = &A;
             ChessBot* threadBotB = &B;
 
-            if (config.depth > 0) {
-                threadBotA->setMaxDepth(config.depth);
-                threadBotB->setMaxDepth(config.depth);
+            if (searchDepth > 0) {
+                threadBotA->setMaxDepth(searchDepth);
+                threadBotB->setMaxDepth(searchDepth);
             }
+            threadBotA->setNodeLimit(config.nodes);
+            threadBotB->setNodeLimit(config.nodes);
+            threadBotA->setTimeLimit(config.moveTimeMs);
+            threadBotB->setTimeLimit(config.moveTimeMs);
+            A.setMultiPV(config.multiPV);
+            threadBotA->setUseNnue(useNnue);
+            threadBotA->setEvalWeights(botAWeights);
+            threadBotB->setEvalWeights(botBWeights);
 
             // Per-thread RNG seeded uniquely
             std::mt19937 rng(std::random_device{}() + omp_get_thread_num());
 
 #pragma omp for schedule(dynamic)
             for (int g = 1; g <= totalGames; g++) {
-                bool botAIsWhite = std::uniform_int_distribution<int>(0, 1)(rng) == 0;
+                bool botAIsWhite;
+                if (config.seedSpecified) {
+                    // Everything random in game g derives from (seed, g), so results
+                    // don't depend on which thread plays it or the thread count.
+                    // seed_seq mixes them into separate streams for the color draw
+                    // and each bot (plain seed + g sums overlap across games).
+                    std::seed_seq seq{ config.seed, static_cast<uint32_t>(g) };
+                    uint32_t streams[3];
+                    seq.generate(streams, streams + 3);
+                    botAIsWhite = (std::mt19937(streams[0])() & 1) == 0;
+                    threadBotA->setSeed(streams[1]);
+                    threadBotB->setSeed(streams[2]);
+                } else {
+                    botAIsWhite = std::uniform_int_distribution<int>(0, 1)(rng) == 0;
+                }
                 // bool botAIsWhite = false;
 
+                // Bots are reused across this thread's games; start each one cold
+                threadBotA->newGame();
+                threadBotB->newGame();
+
                 Game game(config);
                 if (botAIsWhite) {
                     game.setWhiteBot(threadBotA);
@@ -0,0 +1,346 @@
+// Opening book builder: replays games and writes a Polyglot book (Book.h).
+//
+// Input is PGN (SAN movetext; tags, comments, variations and NAGs are
+// skipped) or self-play records in the coordinate notation the engine
+// prints (e2e4 e7e5 g1f3 ... 1-0), one or more games per file. A game ends
+// at its result token; games without a result ("*") are skipped.
+//
+// Games are read sequentially in batches and replayed with MoveValidator in
+// parallel. Every (position key, move) pair within the first --plies plies
+// gets win/draw/loss counts from the mover's point of view, kept in a hash
+// map per thread. A map that outgrows its share of --memory is sorted and
+// spilled to a run file next to the output; the runs are then merged (an
+// external merge sort), so memory stays bounded however many games there are.
+//
+// Entry weight is 2 * wins + draws (scaled down per position to fit 16 bits);
+// pairs seen in fewer than --min-games games, or that never scored, are dropped.
+//
+// Usage: bookgen [--out book.bin] [--plies n] [--min-games n] [--memory mb] [--threads n] games.pgn ...
+
+#include "BitboardEngine.h"
+#include "Book.h"
+#include "MoveValidator.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <omp.h>
+
+bool g_debugOutput = false;
+
+namespace {
+
+enum Result { WHITE_WINS = 0, BLACK_WINS = 1, DRAW = 2, UNKNOWN = -1 };
+
+struct GameText {
+    std::vector<std::string> moves;
+    int result = UNKNOWN;
+};
+
+// Splits a PGN or record stream into games, one at a time
+class GameReader {
+public:
+    explicit GameReader(std::istream& in) : in(in) {}
+
+    bool next(GameText& game) {
+        game = GameText();
+        int tagResult = UNKNOWN;
+        std::string token;
+        int c;
+        while ((c = in.get()) != EOF) {
+            if (c == '[') {
+                // A tag section after movetext starts the next game
+                if (!game.moves.empty()) {
+                    in.unget();
+                    game.result = tagResult;
+                    return true;
+                }
+                std::string tag;
+                while ((c = in.get()) != EOF && c != ']') tag += static_cast<char>(c);
+                if (tag.compare(0, 6, "Result") == 0) tagResult = parseResult(tag.substr(tag.find('"') + 1, tag.rfind('"') - tag.find('"') - 1));
+            } else if (c == '{') {
+                while ((c = in.get()) != EOF && c != '}') {}
+            } else if (c == ';' || c == '%') {
+                while ((c = in.get()) != EOF && c != '\n') {}
+            } else if (c == '(') {
+                for (int depth = 1; depth > 0 && (c = in.get()) != EOF;) {
+                    if (c == '(') depth++;
+                    else if (c == ')') depth--;
+                    else if (c == '{') while ((c = in.get()) != EOF && c != '}') {}
+                }
+            } else if (std::isspace(c)) {
+                continue;
+            } else {
+                token = static_cast<char>(c);
+                while ((c = in.peek()) != EOF && !std::isspace(c) && c != '{' && c != '(' && c != ';' && c != '[') {
+                    token += static_cast<char>(in.get());
+                }
+                int result = parseResult(token);
+                if (result != UNKNOWN || token == "*") {
+                    game.result = result;
+                    return true;
+                }
+                addMove(game, token);
+            }
+        }
+        game.result = tagResult;
+        return !game.moves.empty();
+    }
+
+private:
+    std::istream& in;
+
+    static int parseResult(const std::string& s) {
+        if (s == "1-0") return WHITE_WINS;
+        if (s == "0-1") return BLACK_WINS;
+        if (s == "1/2-1/2") return DRAW;
+        return UNKNOWN;
+    }
+
+    // Drops move numbers ("12." / "12..." / "12.e4") and NAGs
+    static void addMove(GameText& game, std::string token) {
+        if (token[0] == '$') return;
+        if (std::isdigit(static_cast<unsigned char>(token[0]))) {
+            size_t i = 0;
+            while (i < token.size() && std::isdigit(static_cast<unsigned char>(token[i]))) i++;
+            if (i == token.size() || token[i] != '.') {
+                game.moves.push_back(token);  // not a move number; fails to replay
+                return;
+            }
+            while (i < token.size() && token[i] == '.') i++;
+            token = token.substr(i);
+            if (token.empty()) return;
+        }
+        game.moves.push_back(token);
+    }
+};
+
+// Counts for one (position, move) pair
+struct Record {
+    uint64_t key;
+    uint16_t move;
+    uint32_t wins, draws, losses;
+
+    bool operator<(const Record& o) const { return key != o.key ? key < o.key : move < o.move; }
+};
+
+struct PairHash {
+    size_t operator()(const std::pair<uint64_t, uint16_t>& p) const { return p.first ^ (uint64_t(p.second) * 0x9E3779B97F4A7C15ULL); }
+};
+
+using Shard = std::unordered_map<std::pair<uint64_t, uint16_t>, Record, PairHash>;
+
+class Builder {
+public:
+    Builder(const std::string& outPath, int maxPlies, size_t shardLimit)
+        : outPath(outPath), maxPlies(maxPlies), shardLimit(shardLimit), shards(omp_get_max_threads()) {}
+
+    // Replays a batch of games in parallel into the per-thread shards
+    void addBatch(const std::vector<GameText>& games) {
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (int64_t g = 0; g < static_cast<int64_t>(games.size()); g++) {
+            Shard& shard = shards[omp_get_thread_num()];
+            if (replay(games[g], shard)) {
+                #pragma omp atomic
+                replayed++;
+            }
+            if (shard.size() >= shardLimit) spill(shard);
+        }
+    }
+
+    // Spills what is left, merges the runs and writes the book; returns the entry count
+    int64_t finish(int minGames) {
+        for (Shard& shard : shards) {
+            if (!shard.empty()) spill(shard);
+        }
+
+        std::ofstream out(outPath, std::ios::binary);
+        if (!out) {
+            std::cerr << "bookgen: cannot write '" << outPath << "'" << std::endl;
+            return -1;
+        }
+
+        // K-way merge of the sorted runs; equal pairs from different runs are summed
+        struct Run {
+            std::ifstream in;
+            Record current;
+            bool advance() { return static_cast<bool>(in.read(reinterpret_cast<char*>(&current), sizeof(Record))); }
+        };
+        std::vector<Run> runs(runFiles.size());
+        auto later = [&runs](int a, int b) { return runs[b].current < runs[a].current; };
+        std::priority_queue<int, std::vector<int>, decltype(later)> heap(later);
+        for (size_t i = 0; i < runFiles.size(); i++) {
+            runs[i].in.open(runFiles[i], std::ios::binary);
+            if (runs[i].advance()) heap.push(static_cast<int>(i));
+        }
+
+        int64_t written = 0;
+        std::vector<Record> position;  // merged moves of the current key
+        auto flush = [&]() {
+            written += writePosition(out, position, minGames);
+            position.clear();
+        };
+        while (!heap.empty()) {
+            int i = heap.top();
+            heap.pop();
+            const Record& r = runs[i].current;
+            if (!position.empty() && position.back().key != r.key) flush();
+            if (!position.empty() && position.back().move == r.move) {
+                position.back().wins += r.wins;
+                position.back().draws += r.draws;
+                position.back().losses += r.losses;
+            } else {
+                position.push_back(r);
+            }
+            if (runs[i].advance()) heap.push(i);
+        }
+        flush();
+
+        for (Run& run : runs) run.in.close();
+        for (const std::string& file : runFiles) std::remove(file.c_str());
+        return written;
+    }
+
+    int64_t gamesReplayed() const { return replayed; }
+
+private:
+    std::string outPath;
+    int maxPlies;
+    size_t shardLimit;
+    std::vector<Shard> shards;
+    std::vector<std::string> runFiles;
+    int64_t replayed = 0;
+
+    bool replay(const GameText& game, Shard& shard) {
+        BitboardEngine eng;
+        MoveValidator validator(&eng);
+        int color = 0;
+        int plies = std::min(maxPlies, static_cast<int>(game.moves.size()));
+        for (int ply = 0; ply < plies; ply++) {
+            Move move;
+            if (!validator.parseMove(game.moves[ply], color, move)) return false;
+
+            uint64_t key = Book::key(eng, validator, color);
+            uint16_t encoded = Book::encodeMove(move, eng);
+            Record& r = shard.try_emplace({ key, encoded }, Record{ key, encoded, 0, 0, 0 }).first->second;
+            if (game.result == DRAW) r.draws++;
+            else if (game.result == color) r.wins++;
+            else r.losses++;
+
+            validator.executeMove(move, color, true);
+            color ^= 1;
+        }
+        return true;
+    }
+
+    void spill(Shard& shard) {
+        std::vector<Record> records;
+        records.reserve(shard.size());
+        for (const auto& entry : shard) records.push_back(entry.second);
+        Shard().swap(shard);  // release the buckets too
+        std::sort(records.begin(), records.end());
+
+        std::string file;
+        #pragma omp critical(bookgen_runs)
+        {
+            file = outPath + ".run" + std::to_string(runFiles.size()) + ".tmp";
+            runFiles.push_back(file);
+        }
+        std::ofstream out(file, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(Record)));
+    }
+
+    // Writes one position's moves, best first; returns how many were kept
+    static int writePosition(std::ofstream& out, std::vector<Record>& moves, int minGames) {
+        std::vector<std::pair<uint64_t, uint16_t>> kept;  // (score, move)
+        uint64_t best = 0;
+        for (const Record& r : moves) {
+            uint64_t score = 2ULL * r.wins + r.draws;
+            if (r.wins + r.draws + r.losses < static_cast<uint32_t>(minGames) || score == 0) continue;
+            kept.push_back({ score, r.move });
+            best = std::max(best, score);
+        }
+        std::sort(kept.begin(), kept.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        uint64_t divisor = (best + 65534) / 65535;  // keep the largest weight within 16 bits
+        for (const auto& k : kept) {
+            uint16_t weight = static_cast<uint16_t>(std::max<uint64_t>(1, k.first / divisor));
+            unsigned char entry[16];
+            uint64_t key = moves[0].key;
+            for (int b = 0; b < 8; b++) entry[b] = static_cast<unsigned char>(key >> (56 - 8 * b));
+            entry[8] = static_cast<unsigned char>(k.second >> 8);
+            entry[9] = static_cast<unsigned char>(k.second);
+            entry[10] = static_cast<unsigned char>(weight >> 8);
+            entry[11] = static_cast<unsigned char>(weight);
+            entry[12] = entry[13] = entry[14] = entry[15] = 0;  // learn
+            out.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+        }
+        return static_cast<int>(kept.size());
+    }
+};
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string outPath = "book.bin";
+    int maxPlies = 24;
+    int minGames = 2;
+    size_t memoryMb = 1024;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "--plies" && i + 1 < argc) maxPlies = std::stoi(argv[++i]);
+        else if (arg == "--min-games" && i + 1 < argc) minGames = std::stoi(argv[++i]);
+        else if (arg == "--memory" && i + 1 < argc) memoryMb = std::stoul(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) omp_set_num_threads(std::stoi(argv[++i]));
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) {
+        std::cerr << "Usage: bookgen [--out book.bin] [--plies n] [--min-games n] [--memory mb] [--threads n] games.pgn ..."
+                  << std::endl;
+        return 1;
+    }
+
+    // Roughly 64 bytes per hash map entry, split across the thread shards
+    size_t shardLimit = std::max<size_t>(1024, memoryMb * 1024 * 1024 / 64 / omp_get_max_threads());
+    Builder builder(outPath, maxPlies, shardLimit);
+
+    constexpr size_t BATCH = 4096;
+    int64_t gamesRead = 0, skipped = 0;
+    std::vector<GameText> batch;
+    for (const std::string& path : inputs) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "bookgen: cannot open '" << path << "'" << std::endl;
+            return 1;
+        }
+        GameReader reader(in);
+        GameText game;
+        while (reader.next(game)) {
+            gamesRead++;
+            if (game.result == UNKNOWN) {
+                skipped++;
+                continue;
+            }
+            batch.push_back(std::move(game));
+            if (batch.size() == BATCH) {
+                builder.addBatch(batch);
+                batch.clear();
+            }
+        }
+    }
+    builder.addBatch(batch);
+
+    int64_t entries = builder.finish(minGames);
+    if (entries < 0) return 1;
+    std::printf("%lld games read, %lld without a result, %lld replayed in full; %lld book entries written to %s\n",
+                static_cast<long long>(gamesRead), static_cast<long long>(skipped),
+                static_cast<long long>(builder.gamesReplayed()), static_cast<long long>(entries), outPath.c_str());
+    return 0;
+}
@@ -0,0 +1,271 @@
+// Micro-benchmarks for the engine's building blocks, timed in isolation over a
+// position corpus (the --bench positions by default, or an EPD/FEN file).
+//
+// Each benchmark runs a batch of operations over the whole corpus. The batch
+// count is calibrated so that one sample takes about --min-time ms, then
+// --samples samples are taken. Reported per operation: mean, standard
+// deviation and the fastest sample, in nanoseconds.
+//
+//   movegen         every legal move of the side to move (the bots' generateAllMoves loop)
+//   getValidMoves   legal moves of one piece
+//   executeMove     make a legal move and restore the engine and validator state
+//   stateRestore    the save/restore alone (getState / setState on both)
+//   isSquareAttacked  one square, one attacking color
+//   evaluate        Eval::evaluate (PeSTO; pawn and material hashes warm)
+//   evalPawnStructure  one side's pawn-structure terms
+//
+// Usage: microbench [--json] [--samples n] [--min-time ms] [--filter name] [--positions file]
+
+#include "BenchPositions.h"
+#include "BitboardEngine.h"
+#include "Evaluation.h"
+#include "MoveValidator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+bool g_debugOutput = false;
+
+namespace {
+
+// Keeps the compiler from discarding a result it can see is unused
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Position {
+    std::unique_ptr<BitboardEngine> eng;
+    std::unique_ptr<MoveValidator> validator;
+    int sideToMove;
+    std::vector<Move> moves;  // legal moves, for executeMove
+};
+
+// Legal moves of color (same loop as the bots' generateAllMoves); returns the count
+int generateMoves(BitboardEngine& eng, MoveValidator& validator, int color, Move* out) {
+    int count = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            int piece = eng.getPieceAt(row, col);
+            if (piece == BitboardEngine::EMPTY || piece % 2 != color) continue;
+            count += validator.getValidMoves(row, col, color, out + count);
+        }
+    }
+    return count;
+}
+
+struct Benchmark {
+    std::string name;
+    // Runs one batch over the corpus and returns the number of operations it did
+    std::function<int64_t(std::vector<Position>&)> batch;
+};
+
+struct Result {
+    std::string name;
+    int64_t opsPerSample;
+    double mean, stddev, best;  // ns per operation
+};
+
+Result measure(const Benchmark& bench, std::vector<Position>& corpus, int samples, double minTimeMs) {
+    using Clock = std::chrono::steady_clock;
+    auto elapsedNs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    // Calibrate: double the batch count until one sample takes long enough
+    int64_t batches = 1;
+    for (;;) {
+        auto start = Clock::now();
+        for (int64_t b = 0; b < batches; b++) bench.batch(corpus);
+        if (elapsedNs(start) >= minTimeMs * 1e6 || batches >= (int64_t(1) << 30)) break;
+        batches *= 2;
+    }
+
+    Result r{ bench.name, 0, 0, 0, 0 };
+    std::vector<double> perOp;
+    for (int s = 0; s < samples; s++) {
+        int64_t ops = 0;
+        auto start = Clock::now();
+        for (int64_t b = 0; b < batches; b++) ops += bench.batch(corpus);
+        perOp.push_back(elapsedNs(start) / static_cast<double>(std::max<int64_t>(ops, 1)));
+        r.opsPerSample = ops;
+    }
+    for (double v : perOp) r.mean += v;
+    r.mean /= perOp.size();
+    for (double v : perOp) r.stddev += (v - r.mean) * (v - r.mean);
+    r.stddev = perOp.size() > 1 ? std::sqrt(r.stddev / (perOp.size() - 1)) : 0;
+    r.best = *std::min_element(perOp.begin(), perOp.end());
+    return r;
+}
+
+std::vector<Benchmark> benchmarks() {
+    std::vector<Benchmark> list;
+
+    list.push_back({ "movegen", [](std::vector<Position>& corpus) {
+        Move moves[256];
+        for (Position& p : corpus) keep(generateMoves(*p.eng, *p.validator, p.sideToMove, moves));
+        return static_cast<int64_t>(corpus.size());
+    } });
+
+    list.push_back({ "getValidMoves", [](std::vector<Position>& corpus) {
+        Move moves[MoveValidator::MAX_PIECE_MOVES];
+        int64_t ops = 0;
+        for (Position& p : corpus) {
+            Bitboard own = p.sideToMove == 0 ? p.eng->allWhitePieces : p.eng->allBlackPieces;
+            while (own) {
+                int sq = __builtin_ctzll(own);
+                keep(p.validator->getValidMoves(sq / 8, sq % 8, p.sideToMove, moves));
+                own &= own - 1;
+                ops++;
+            }
+        }
+        return ops;
+    } });
+
+    list.push_back({ "executeMove", [](std::vector<Position>& corpus) {
+        int64_t ops = 0;
+        for (Position& p : corpus) {
+            for (const Move& m : p.moves) {
+                BitboardEngine::EngineState engState = p.eng->getState();
+                MoveValidator::ValidatorState valState = p.validator->getState();
+                Move move = m;
+                keep(p.validator->executeMove(move, p.sideToMove, true));
+                p.eng->setState(engState);
+                p.validator->setState(valState);
+            }
+            ops += p.moves.size();
+        }
+        return ops;
+    } });
+
+    list.push_back({ "stateRestore", [](std::vector<Position>& corpus) {
+        for (Position& p : corpus) {
+            BitboardEngine::EngineState engState = p.eng->getState();
+            MoveValidator::ValidatorState valState = p.validator->getState();
+            keep(engState);
+            p.eng->setState(engState);
+            p.validator->setState(valState);
+        }
+        return static_cast<int64_t>(corpus.size());
+    } });
+
+    list.push_back({ "isSquareAttacked", [](std::vector<Position>& corpus) {
+        for (Position& p : corpus) {
+            for (int sq = 0; sq < 64; sq++) {
+                keep(p.validator->isSquareAttacked(sq / 8, sq % 8, 0));
+                keep(p.validator->isSquareAttacked(sq / 8, sq % 8, 1));
+            }
+        }
+        return static_cast<int64_t>(corpus.size()) * 128;
+    } });
+
+    list.push_back({ "evaluate", [](std::vector<Position>& corpus) {
+        for (Position& p : corpus) keep(Eval::evaluate(*p.eng));
+        return static_cast<int64_t>(corpus.size());
+    } });
+
+    list.push_back({ "evalPawnStructure", [](std::vector<Position>& corpus) {
+        for (Position& p : corpus) {
+            const Eval::Weights& w = p.eng->getWeights();
+            for (int color = 0; color < 2; color++) {
+                int mg, eg;
+                Eval::evalPawnStructure(w, p.eng->pawns[color], p.eng->pawns[color ^ 1], color, mg, eg);
+                keep(mg);
+                keep(eg);
+            }
+        }
+        return static_cast<int64_t>(corpus.size()) * 2;
+    } });
+
+    return list;
+}
+
+bool loadCorpus(const std::string& path, std::vector<Position>& corpus) {
+    std::vector<std::string> lines;
+    if (path.empty()) {
+        lines.assign(std::begin(Bench::POSITIONS), std::end(Bench::POSITIONS));
+    } else {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "microbench: cannot open '" << path << "'" << std::endl;
+            return false;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty() && line[0] != '#') lines.push_back(line);
+        }
+    }
+
+    for (const std::string& line : lines) {
+        Position p;
+        p.eng = std::make_unique<BitboardEngine>();
+        p.validator = std::make_unique<MoveValidator>(p.eng.get());
+        FenState state;
+        if (!p.validator->loadFen(line, state) && !p.validator->loadEpd(line, state)) {
+            std::cerr << "microbench: skipping bad position: " << line << std::endl;
+            continue;
+        }
+        p.sideToMove = state.sideToMove;
+        Move moves[256];
+        p.moves.assign(moves, moves + generateMoves(*p.eng, *p.validator, p.sideToMove, moves));
+        corpus.push_back(std::move(p));
+    }
+    if (corpus.empty()) std::cerr << "microbench: no positions" << std::endl;
+    return !corpus.empty();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    int samples = 10;
+    double minTimeMs = 20;
+    std::string filter, positionsFile;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--json") json = true;
+        else if (arg == "--samples" && i + 1 < argc) samples = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--min-time" && i + 1 < argc) minTimeMs = std::stod(argv[++i]);
+        else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "--positions" && i + 1 < argc) positionsFile = argv[++i];
+        else {
+            std::cerr << "Usage: microbench [--json] [--samples n] [--min-time ms] [--filter name] [--positions file]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Position> corpus;
+    if (!loadCorpus(positionsFile, corpus)) return 1;
+
+    std::vector<Result> results;
+    for (const Benchmark& bench : benchmarks()) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+        results.push_back(measure(bench, corpus, samples, minTimeMs));
+        const Result& r = results.back();
+        if (!json) {
+            std::printf("%-18s %10.1f ns/op  +- %6.1f  (best %8.1f, %lld ops/sample)\n", r.name.c_str(), r.mean,
+                        r.stddev, r.best, static_cast<long long>(r.opsPerSample));
+        }
+    }
+
+    if (json) {
+        std::printf("{\n  \"positions\": %zu,\n  \"samples\": %d,\n  \"benchmarks\": [\n", corpus.size(), samples);
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            std::printf("    {\"name\": \"%s\", \"ns_per_op\": %.2f, \"stddev\": %.2f, \"best\": %.2f, \"ops_per_sample\": %lld}%s\n",
+                        r.name.c_str(), r.mean, r.stddev, r.best, static_cast<long long>(r.opsPerSample),
+                        i + 1 < results.size() ? "," : "");
+        }
+        std::printf("  ]\n}\n");
+    }
+    return 0;
+}
@@ -0,0 +1,356 @@
+// Endgame tablebase generator for the tables read by Tablebase.h.
+//
+// Every position of a material signature is enumerated by its table index and
+// solved by retrograde analysis, pass by pass: after the initial pass marks
+// checkmates (lost in 0) and stalemates, pass p finds the positions won in p
+// plies (some move reaches a position lost in p - 1) and lost in p plies
+// (every move reaches a won position and the slowest win takes p - 1). Moves
+// that capture or promote leave the table; their results come from the
+// smaller tables, which are generated first (and written too). Whatever is
+// still unresolved when the passes stop changing anything is a draw. Each
+// pass runs over the index in parallel with OpenMP.
+//
+// Usage: tbgen [--out dir] [--threads n] KQK KRK KQKR ...
+// Names list white's pieces after the first K and black's after the second
+// (Q R B N P, up to Tablebase::MAX_PIECES pieces in all).
+
+#include "Attacks.h"
+#include "BitboardEngine.h"
+#include "Endgame.h"
+#include "Tablebase.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+bool g_debugOutput = false;
+
+namespace {
+
+using Tablebase::Layout;
+using Tablebase::PieceSquare;
+using Tablebase::MAX_PIECES;
+
+struct Position {
+    PieceSquare pieces[MAX_PIECES];
+    int count;
+    int sideToMove;
+};
+
+struct SolvedTable {
+    Layout layout;
+    std::vector<uint8_t> values;
+};
+
+std::map<uint64_t, SolvedTable> solved;  // by material key, as generated (one colour assignment)
+
+const uint64_t KK_KEY = Endgame::materialUnit(BitboardEngine::WHITE_KING) + Endgame::materialUnit(BitboardEngine::BLACK_KING);
+
+uint64_t materialKeyOf(const Position& pos) {
+    uint64_t key = 0;
+    for (int i = 0; i < pos.count; i++) key += Endgame::materialUnit(pos.pieces[i].piece);
+    return key;
+}
+
+Bitboard occupancy(const Position& pos) {
+    Bitboard occ = 0;
+    for (int i = 0; i < pos.count; i++) occ |= 1ULL << pos.pieces[i].square;
+    return occ;
+}
+
+Bitboard attacksFrom(int piece, int sq, Bitboard occupied) {
+    switch (piece / 2) {
+        case 0:  return Attacks::pawnAttacks(piece % 2, sq);
+        case 1:  return Attacks::rookAttacks(sq, occupied);
+        case 2:  return Attacks::knightAttacks(sq);
+        case 3:  return Attacks::bishopAttacks(sq, occupied);
+        case 4:  return Attacks::queenAttacks(sq, occupied);
+        default: return Attacks::kingAttacks(sq);
+    }
+}
+
+bool inCheck(const Position& pos, int color) {
+    Bitboard occupied = occupancy(pos);
+    int king = -1;
+    for (int i = 0; i < pos.count; i++) {
+        if (pos.pieces[i].piece == BitboardEngine::WHITE_KING + color) king = pos.pieces[i].square;
+    }
+    for (int i = 0; i < pos.count; i++) {
+        const PieceSquare& p = pos.pieces[i];
+        if (p.piece % 2 != color && (attacksFrom(p.piece, p.square, occupied) >> king & 1)) return true;
+    }
+    return false;
+}
+
+// Pieces on distinct squares, no pawn on a back rank, side not to move not in check
+bool isLegal(const Position& pos) {
+    Bitboard seen = 0;
+    for (int i = 0; i < pos.count; i++) {
+        Bitboard bit = 1ULL << pos.pieces[i].square;
+        int row = pos.pieces[i].square / 8;
+        if ((seen & bit) || (pos.pieces[i].piece / 2 == 0 && (row == 0 || row == 7))) return false;
+        seen |= bit;
+    }
+    return !inCheck(pos, pos.sideToMove ^ 1);
+}
+
+// Calls visit(child, leavesTable) for every legal move; leavesTable is true for
+// captures and promotions. No castling or en passant in tablebase positions.
+template <class Visit>
+int forEachMove(const Position& pos, Visit&& visit) {
+    int us = pos.sideToMove;
+    Bitboard occupied = occupancy(pos);
+    Bitboard own = 0;
+    for (int i = 0; i < pos.count; i++) {
+        if (pos.pieces[i].piece % 2 == us) own |= 1ULL << pos.pieces[i].square;
+    }
+
+    int legal = 0;
+    auto play = [&](int i, int to, int promotion) {
+        Position child = pos;
+        bool capture = false;
+        for (int j = 0; j < child.count; j++) {
+            if (child.pieces[j].square == to) {
+                child.pieces[j] = child.pieces[--child.count];
+                if (i == child.count) i = j;  // the mover was the last entry
+                capture = true;
+                break;
+            }
+        }
+        child.pieces[i].square = to;
+        if (promotion >= 0) child.pieces[i].piece = promotion;
+        child.sideToMove = us ^ 1;
+        if (inCheck(child, us)) return;
+        legal++;
+        visit(child, capture || promotion >= 0);
+    };
+
+    for (int i = 0; i < pos.count; i++) {
+        int piece = pos.pieces[i].piece, from = pos.pieces[i].square;
+        if (piece % 2 != us) continue;
+        Bitboard targets;
+        if (piece / 2 == 0) {
+            // White pawns move toward lower indices
+            int push = us == 0 ? from - 8 : from + 8;
+            targets = Attacks::pawnAttacks(us, from) & occupied & ~own;
+            if (!(occupied >> push & 1)) {
+                targets |= 1ULL << push;
+                int start = us == 0 ? 6 : 1, jump = us == 0 ? push - 8 : push + 8;
+                if (from / 8 == start && !(occupied >> jump & 1)) targets |= 1ULL << jump;
+            }
+        } else {
+            targets = attacksFrom(piece, from, occupied) & ~own;
+        }
+        while (targets) {
+            int to = __builtin_ctzll(targets);
+            targets &= targets - 1;
+            if (piece / 2 == 0 && (to / 8 == 0 || to / 8 == 7)) {
+                for (int promotion : { BitboardEngine::WHITE_QUEEN, BitboardEngine::WHITE_ROOK,
+                                       BitboardEngine::WHITE_BISHOP, BitboardEngine::WHITE_KNIGHT }) {
+                    play(i, to, promotion + us);
+                }
+            } else {
+                play(i, to, -1);
+            }
+        }
+    }
+    return legal;
+}
+
+// Value of a position from a finished table (kings only: draw)
+uint8_t lookup(const Position& pos) {
+    uint64_t key = materialKeyOf(pos);
+    if (key == KK_KEY) return Tablebase::DRAW;
+    auto it = solved.find(key);
+    if (it != solved.end()) return it->second.values[Tablebase::encode(it->second.layout, pos.pieces, pos.sideToMove)];
+
+    it = solved.find(Tablebase::flipMaterialKey(key));
+    Position flipped = pos;
+    for (int i = 0; i < pos.count; i++) flipped.pieces[i] = { pos.pieces[i].piece ^ 1, pos.pieces[i].square ^ 56 };
+    return it->second.values[Tablebase::encode(it->second.layout, flipped.pieces, pos.sideToMove ^ 1)];
+}
+
+// Orientation a signature is generated in: the side with more material is white
+uint64_t canonicalKey(uint64_t key) {
+    constexpr int VALUE[6] = { 1, 5, 3, 3, 9, 0 };  // by piece / 2
+    int material[2] = { 0, 0 };
+    for (int piece = 0; piece < 12; piece++) material[piece % 2] += VALUE[piece / 2] * Endgame::pieceCount(key, piece);
+    return material[1] > material[0] ? Tablebase::flipMaterialKey(key) : key;
+}
+
+// Signatures a capture, promotion or capture-promotion can reach
+std::vector<uint64_t> childKeys(uint64_t key) {
+    std::vector<uint64_t> children;
+    for (int piece = 0; piece < 10; piece++) {
+        if (Endgame::pieceCount(key, piece)) children.push_back(key - Endgame::materialUnit(piece));
+    }
+    for (int color = 0; color < 2; color++) {
+        if (!Endgame::pieceCount(key, BitboardEngine::WHITE_PAWN + color)) continue;
+        for (int promotion = BitboardEngine::WHITE_ROOK; promotion <= BitboardEngine::WHITE_QUEEN; promotion += 2) {
+            uint64_t promoted = key - Endgame::materialUnit(BitboardEngine::WHITE_PAWN + color)
+                              + Endgame::materialUnit(promotion + color);
+            children.push_back(promoted);
+            for (int victim = BitboardEngine::WHITE_ROOK; victim <= BitboardEngine::WHITE_QUEEN; victim += 2) {
+                int enemy = victim + (color ^ 1);
+                if (Endgame::pieceCount(promoted, enemy)) children.push_back(promoted - Endgame::materialUnit(enemy));
+            }
+        }
+    }
+    return children;
+}
+
+std::vector<uint8_t> solve(const Layout& layout) {
+    using namespace Tablebase;
+    const int64_t size = static_cast<int64_t>(layout.size);
+    std::vector<uint8_t> values(size);
+    // Results of the moves that leave the table, which never change:
+    // fastest loss (or 255 if none) and slowest win (255 if one is a draw)
+    std::vector<uint8_t> exitLoss(size, 255), exitWin(size, 0);
+
+    auto decodePosition = [&](int64_t idx, Position& pos) {
+        int squares[MAX_PIECES];
+        decode(layout, static_cast<uint64_t>(idx), squares, pos.sideToMove);
+        pos.count = layout.count;
+        for (int s = 0; s < layout.count; s++) pos.pieces[s] = { layout.pieces[s], squares[s] };
+    };
+
+    int longestExit = 0;
+    #pragma omp parallel for schedule(dynamic, 4096) reduction(max:longestExit)
+    for (int64_t idx = 0; idx < size; idx++) {
+        Position pos;
+        decodePosition(idx, pos);
+        if (!isLegal(pos)) {
+            values[idx] = ILLEGAL;
+            continue;
+        }
+        int moves = forEachMove(pos, [&](const Position& child, bool leavesTable) {
+            if (!leavesTable) return;
+            uint8_t v = lookup(child);
+            if (isLoss(v)) exitLoss[idx] = std::min<uint8_t>(exitLoss[idx], distance(v));
+            else if (isWin(v) && exitWin[idx] != 255) exitWin[idx] = std::max<uint8_t>(exitWin[idx], distance(v));
+            else exitWin[idx] = 255;
+        });
+        if (exitLoss[idx] != 255) longestExit = std::max<int>(longestExit, exitLoss[idx]);
+        if (exitWin[idx] != 255) longestExit = std::max<int>(longestExit, exitWin[idx]);
+        values[idx] = moves ? UNKNOWN : inCheck(pos, pos.sideToMove) ? lossIn(0) : DRAW;
+    }
+
+    // Wins are always an odd number of plies and losses an even number, so
+    // odd passes only look for wins and even passes only for losses
+    std::vector<uint8_t> next;
+    for (int p = 1;; p++) {
+        next = values;
+        int64_t changed = 0;
+        #pragma omp parallel for schedule(dynamic, 4096) reduction(+:changed)
+        for (int64_t idx = 0; idx < size; idx++) {
+            if (values[idx] != UNKNOWN) continue;
+            Position pos;
+            decodePosition(idx, pos);
+            if (p % 2 == 1) {
+                bool win = exitLoss[idx] == p - 1;
+                forEachMove(pos, [&](const Position& child, bool leavesTable) {
+                    if (!win && !leavesTable) win = values[encode(layout, child.pieces, child.sideToMove)] == lossIn(p - 1);
+                });
+                if (win) {
+                    next[idx] = winIn(p);
+                    changed++;
+                }
+            } else {
+                if (exitWin[idx] == 255 || exitLoss[idx] != 255) continue;
+                bool allWins = true;
+                int slowest = exitWin[idx];
+                forEachMove(pos, [&](const Position& child, bool leavesTable) {
+                    if (!allWins || leavesTable) return;
+                    uint8_t v = values[encode(layout, child.pieces, child.sideToMove)];
+                    if (isWin(v)) slowest = std::max<int>(slowest, distance(v));
+                    else allWins = false;
+                });
+                if (allWins && slowest == p - 1) {
+                    next[idx] = lossIn(p);
+                    changed++;
+                }
+            }
+        }
+        values.swap(next);
+
+        if (changed == 0 && p > longestExit + 1) break;
+        if (p == MAX_DISTANCE) {
+            std::cerr << "tbgen: " << layout.name << " has results beyond " << MAX_DISTANCE << " plies" << std::endl;
+            return {};
+        }
+    }
+
+    for (uint8_t& v : values) {
+        if (v == UNKNOWN) v = DRAW;
+    }
+    return values;
+}
+
+bool generate(uint64_t key, const std::string& outDir) {
+    if (key == KK_KEY || solved.count(key) || solved.count(Tablebase::flipMaterialKey(key))) return true;
+    for (uint64_t child : childKeys(key)) {
+        if (!generate(canonicalKey(child), outDir)) return false;
+    }
+
+    Layout layout;
+    Tablebase::parseLayout(Tablebase::nameOf(key), layout);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> values = solve(layout);
+    if (values.empty()) return false;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Summary with white to move (the first half of the index)
+    int64_t wins = 0, losses = 0, draws = 0;
+    int longest = 0;
+    for (uint64_t idx = 0; idx < layout.size / 2; idx++) {
+        uint8_t v = values[idx];
+        if (v == Tablebase::ILLEGAL) continue;
+        if (Tablebase::isWin(v)) wins++;
+        else if (Tablebase::isLoss(v)) losses++;
+        else draws++;
+        if (v != Tablebase::DRAW) longest = std::max(longest, Tablebase::distance(v));
+    }
+    std::string path = outDir + "/" + layout.name + ".tb";
+    if (!Tablebase::save(path, layout, values)) {
+        std::cerr << "tbgen: cannot write '" << path << "'" << std::endl;
+        return false;
+    }
+    std::printf("%-6s %10llu entries  white to move: %lld won, %lld drawn, %lld lost  longest mate %d plies  %.1fs\n",
+                layout.name.c_str(), static_cast<unsigned long long>(layout.size),
+                static_cast<long long>(wins), static_cast<long long>(draws), static_cast<long long>(losses),
+                longest, seconds);
+    solved[key] = { layout, std::move(values) };
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string outDir = ".";
+    std::vector<std::string> names;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) outDir = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) omp_set_num_threads(std::stoi(argv[++i]));
+        else names.push_back(arg);
+    }
+    if (names.empty()) {
+        std::cerr << "Usage: tbgen [--out dir] [--threads n] KQK KRK KQKR ..." << std::endl;
+        return 1;
+    }
+
+    for (const std::string& name : names) {
+        Layout layout;
+        if (!Tablebase::parseLayout(name, layout)) {
+            std::cerr << "tbgen: '" << name << "' is not a signature of at most "
+                      << MAX_PIECES << " pieces like KQKR" << std::endl;
+            return 1;
+        }
+        if (!generate(layout.materialKey, outDir)) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,444 @@
+// Texel tuner for the PeSTO evaluation weights in Evaluation.h.
+//
+// Loads quiet positions labeled with game results, one per line, in either
+// common format:
+//   <fen> [1.0]                 (result from white's view: 1.0 / 0.5 / 0.0)
+//   <fen> c9 "1-0";             (EPD opcode: "1-0" / "1/2-1/2" / "0-1")
+// Only the piece placement field of the FEN is used.
+//
+// Every eval term in Eval::evaluate is linear in its weight, so each position
+// is reduced once to a compact feature record (piece list, pawn-structure and
+// mobility counts, phase) and the tuner minimizes
+//   mean (result - sigmoid(K * eval / 400))^2
+// with full-batch Adam, computing gradients across threads with OpenMP. The
+// tuned weights are written as a drop-in replacement for the weights block at
+// the top of Evaluation.h.
+//
+// Usage: tune <positions> [--iterations n] [--lr x] [--out file] [--bin file] [--threads n]
+// --bin additionally writes the binary format read by Eval::loadWeights.
+
+#include "BitboardEngine.h"
+#include "Evaluation.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+bool g_debugOutput = false;
+
+namespace {
+
+// Parameter vector layout. Piece-type order is piece / 2 (pawn, rook, knight, bishop, queen, king).
+constexpr int P_MG_VAL         = 0;                  // [5] material, kings have none
+constexpr int P_EG_VAL         = P_MG_VAL + 5;
+constexpr int P_MG_PST         = P_EG_VAL + 5;       // [6][64]
+constexpr int P_EG_PST         = P_MG_PST + 6 * 64;
+constexpr int P_DOUBLED        = P_EG_PST + 6 * 64;  // pawn terms apply to both phases
+constexpr int P_ISOLATED       = P_DOUBLED + 1;
+constexpr int P_BACKWARD       = P_ISOLATED + 1;
+constexpr int P_PASSED         = P_BACKWARD + 1;     // [8], middlegame gets half
+constexpr int P_MOBILITY_MG    = P_PASSED + 8;
+constexpr int P_MOBILITY_EG    = P_MOBILITY_MG + 1;
+constexpr int P_BISHOP_PAIR_MG = P_MOBILITY_EG + 1;
+constexpr int P_BISHOP_PAIR_EG = P_BISHOP_PAIR_MG + 1;
+constexpr int NUM_PARAMS       = P_BISHOP_PAIR_EG + 1;
+
+// One training position. Pieces live in a shared pool as (piece << 6 | square)
+// so a position costs ~70 bytes; counts are white minus black.
+struct TuneEntry {
+    uint32_t pieceOffset;
+    uint8_t pieceCount;
+    uint8_t phase;           // capped game phase, 0..TOTAL_PHASE
+    float result;            // 1 = white win, 0.5 = draw, 0 = black win
+    int8_t doubled, isolated, backward, bishopPair;
+    int8_t passed[8];        // by PASSED_PAWN_BONUS index
+    int16_t mobility;
+};
+
+struct Dataset {
+    std::vector<TuneEntry> entries;
+    std::vector<uint16_t> pieces;
+};
+
+// Parsed line before it is appended to the dataset
+struct ParsedLine {
+    bool ok = false;
+    TuneEntry entry;
+    uint16_t pieces[32];
+};
+
+bool parseResult(const std::string& line, float& result) {
+    size_t pos;
+    if ((pos = line.find('[')) != std::string::npos) {
+        result = std::strtof(line.c_str() + pos + 1, nullptr);
+        return true;
+    }
+    if (line.find("\"1-0\"") != std::string::npos)     { result = 1.0f; return true; }
+    if (line.find("\"0-1\"") != std::string::npos)     { result = 0.0f; return true; }
+    if (line.find("\"1/2-1/2\"") != std::string::npos) { result = 0.5f; return true; }
+    return false;
+}
+
+ParsedLine extractFeatures(const std::string& line, BitboardEngine& eng) {
+    ParsedLine out;
+    TuneEntry& e = out.entry;
+    if (!parseResult(line, e.result) || !eng.loadPlacement(line)) return out;
+
+    e.pieceCount = 0;
+    Bitboard occupied = eng.allPieces;
+    while (occupied && e.pieceCount < 32) {
+        int sq = __builtin_ctzll(occupied);
+        out.pieces[e.pieceCount++] = static_cast<uint16_t>(eng.getPieceAt(sq / 8, sq % 8) << 6 | sq);
+        occupied &= occupied - 1;
+    }
+    e.phase = static_cast<uint8_t>(Eval::computePhase(eng));
+
+    Eval::PawnTerms w = Eval::pawnTerms(eng.pawns[0], eng.pawns[1], 0);
+    Eval::PawnTerms b = Eval::pawnTerms(eng.pawns[1], eng.pawns[0], 1);
+    e.doubled  = static_cast<int8_t>(w.doubled - b.doubled);
+    e.isolated = static_cast<int8_t>(__builtin_popcountll(w.isolated) - __builtin_popcountll(b.isolated));
+    e.backward = static_cast<int8_t>(__builtin_popcountll(w.backward) - __builtin_popcountll(b.backward));
+    std::memset(e.passed, 0, sizeof(e.passed));
+    for (int color = 0; color < 2; color++) {
+        Bitboard bb = color == 0 ? w.passed : b.passed;
+        while (bb) {
+            int idx = Eval::passedBonusIndex(__builtin_ctzll(bb), color);
+            if (idx >= 0) e.passed[idx] += color == 0 ? 1 : -1;
+            bb &= bb - 1;
+        }
+    }
+
+    Eval::AttackInfo attacks;
+    Eval::computeAttacks(eng, attacks);
+    e.mobility = static_cast<int16_t>(attacks.mobility[0] - attacks.mobility[1]);
+    e.bishopPair = static_cast<int8_t>((__builtin_popcountll(eng.bishops[0]) >= 2) -
+                                       (__builtin_popcountll(eng.bishops[1]) >= 2));
+    out.ok = true;
+    return out;
+}
+
+// Reads the file in chunks and extracts features in parallel
+bool loadDataset(const std::string& path, Dataset& data) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    const size_t CHUNK = 1 << 18;
+    std::vector<std::string> lines;
+    std::vector<ParsedLine> parsed(CHUNK);
+    size_t skipped = 0;
+    std::string line;
+    while (true) {
+        lines.clear();
+        while (lines.size() < CHUNK && std::getline(in, line)) lines.push_back(line);
+        if (lines.empty()) break;
+
+#pragma omp parallel
+        {
+            BitboardEngine eng;
+#pragma omp for schedule(static)
+            for (long i = 0; i < (long)lines.size(); i++) parsed[i] = extractFeatures(lines[i], eng);
+        }
+
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (!parsed[i].ok) { skipped++; continue; }
+            TuneEntry e = parsed[i].entry;
+            e.pieceOffset = static_cast<uint32_t>(data.pieces.size());
+            data.pieces.insert(data.pieces.end(), parsed[i].pieces, parsed[i].pieces + e.pieceCount);
+            data.entries.push_back(e);
+        }
+        std::cerr << "\rLoaded " << data.entries.size() << " positions" << std::flush;
+    }
+    std::cerr << std::endl;
+    if (skipped) std::cerr << "Skipped " << skipped << " unparsable lines" << std::endl;
+    return !data.entries.empty();
+}
+
+std::vector<double> initialParams() {
+    std::vector<double> p(NUM_PARAMS, 0.0);
+    for (int type = 0; type < 5; type++) {
+        p[P_MG_VAL + type] = Eval::MG_PIECE_VAL[type];
+        p[P_EG_VAL + type] = Eval::EG_PIECE_VAL[type];
+    }
+    for (int type = 0; type < 6; type++) {
+        for (int sq = 0; sq < 64; sq++) {
+            p[P_MG_PST + type * 64 + sq] = Eval::MG_TABLES[type][sq];
+            p[P_EG_PST + type * 64 + sq] = Eval::EG_TABLES[type][sq];
+        }
+    }
+    p[P_DOUBLED]  = Eval::DOUBLED_PAWN_PENALTY;
+    p[P_ISOLATED] = Eval::ISOLATED_PAWN_PENALTY;
+    p[P_BACKWARD] = Eval::BACKWARD_PAWN_PENALTY;
+    for (int i = 0; i < 8; i++) p[P_PASSED + i] = Eval::PASSED_PAWN_BONUS[i];
+    p[P_MOBILITY_MG]    = Eval::MOBILITY_MG;
+    p[P_MOBILITY_EG]    = Eval::MOBILITY_EG;
+    p[P_BISHOP_PAIR_MG] = Eval::BISHOP_PAIR_MG;
+    p[P_BISHOP_PAIR_EG] = Eval::BISHOP_PAIR_EG;
+    return p;
+}
+
+// Tapered eval of one entry under params (mirrors Eval::evaluate, minus the
+// Endgame.h special cases, which have no tunable weights)
+inline double evaluate(const TuneEntry& e, const uint16_t* pieces, const double* p) {
+    double mg = 0.0, eg = 0.0;
+    for (int i = 0; i < e.pieceCount; i++) {
+        int piece = pieces[i] >> 6, sq = pieces[i] & 63;
+        int type = piece / 2;
+        double sign = (piece % 2 == 0) ? 1.0 : -1.0;
+        int pst = (piece % 2 == 0) ? sq : (sq ^ 56);
+        mg += sign * p[P_MG_PST + type * 64 + pst];
+        eg += sign * p[P_EG_PST + type * 64 + pst];
+        if (type < 5) {
+            mg += sign * p[P_MG_VAL + type];
+            eg += sign * p[P_EG_VAL + type];
+        }
+    }
+    double pawns = e.doubled * p[P_DOUBLED] + e.isolated * p[P_ISOLATED] + e.backward * p[P_BACKWARD];
+    mg += pawns;
+    eg += pawns;
+    for (int i = 0; i < 8; i++) {
+        mg += 0.5 * e.passed[i] * p[P_PASSED + i];
+        eg += e.passed[i] * p[P_PASSED + i];
+    }
+    mg += e.mobility * p[P_MOBILITY_MG] + e.bishopPair * p[P_BISHOP_PAIR_MG];
+    eg += e.mobility * p[P_MOBILITY_EG] + e.bishopPair * p[P_BISHOP_PAIR_EG];
+    return (mg * e.phase + eg * (Eval::TOTAL_PHASE - e.phase)) / Eval::TOTAL_PHASE;
+}
+
+inline double sigmoid(double k, double eval) { return 1.0 / (1.0 + std::exp(-k * eval * (M_LN10 / 400.0))); }
+
+double meanError(const Dataset& data, const std::vector<double>& params, double k) {
+    double total = 0.0;
+    const long n = (long)data.entries.size();
+#pragma omp parallel for reduction(+:total) schedule(static)
+    for (long i = 0; i < n; i++) {
+        const TuneEntry& e = data.entries[i];
+        double diff = e.result - sigmoid(k, evaluate(e, &data.pieces[e.pieceOffset], params.data()));
+        total += diff * diff;
+    }
+    return total / n;
+}
+
+// Scaling constant that best fits the starting weights (golden-section search)
+double fitK(const Dataset& data, const std::vector<double>& params) {
+    double lo = 0.0, hi = 3.0;
+    const double phi = (std::sqrt(5.0) - 1.0) / 2.0;
+    for (int iter = 0; iter < 40; iter++) {
+        double a = hi - phi * (hi - lo), b = lo + phi * (hi - lo);
+        if (meanError(data, params, a) < meanError(data, params, b)) hi = b; else lo = a;
+    }
+    return (lo + hi) / 2.0;
+}
+
+void computeGradient(const Dataset& data, const std::vector<double>& params, double k,
+                     std::vector<double>& grad) {
+    std::fill(grad.begin(), grad.end(), 0.0);
+    const long n = (long)data.entries.size();
+    const double dSigma = k * std::log(10.0) / 400.0;
+
+#pragma omp parallel
+    {
+        std::vector<double> local(NUM_PARAMS, 0.0);
+#pragma omp for schedule(static)
+        for (long i = 0; i < n; i++) {
+            const TuneEntry& e = data.entries[i];
+            const uint16_t* pieces = &data.pieces[e.pieceOffset];
+            double s = sigmoid(k, evaluate(e, pieces, params.data()));
+            double g = -2.0 * (e.result - s) * s * (1.0 - s) * dSigma;
+            double gMg = g * e.phase / Eval::TOTAL_PHASE;
+            double gEg = g * (Eval::TOTAL_PHASE - e.phase) / Eval::TOTAL_PHASE;
+
+            for (int j = 0; j < e.pieceCount; j++) {
+                int piece = pieces[j] >> 6, sq = pieces[j] & 63;
+                int type = piece / 2;
+                double sign = (piece % 2 == 0) ? 1.0 : -1.0;
+                int pst = (piece % 2 == 0) ? sq : (sq ^ 56);
+                local[P_MG_PST + type * 64 + pst] += sign * gMg;
+                local[P_EG_PST + type * 64 + pst] += sign * gEg;
+                if (type < 5) {
+                    local[P_MG_VAL + type] += sign * gMg;
+                    local[P_EG_VAL + type] += sign * gEg;
+                }
+            }
+            local[P_DOUBLED]  += e.doubled * g;
+            local[P_ISOLATED] += e.isolated * g;
+            local[P_BACKWARD] += e.backward * g;
+            for (int j = 0; j < 8; j++) local[P_PASSED + j] += e.passed[j] * (0.5 * gMg + gEg);
+            local[P_MOBILITY_MG]    += e.mobility * gMg;
+            local[P_MOBILITY_EG]    += e.mobility * gEg;
+            local[P_BISHOP_PAIR_MG] += e.bishopPair * gMg;
+            local[P_BISHOP_PAIR_EG] += e.bishopPair * gEg;
+        }
+#pragma omp critical
+        for (int j = 0; j < NUM_PARAMS; j++) grad[j] += local[j];
+    }
+    for (double& g : grad) g /= n;
+}
+
+// Rounded parameters as a runtime weight set (same rounding as the text block)
+Eval::Weights toWeights(const std::vector<double>& p) {
+    Eval::Weights w = Eval::DEFAULT_WEIGHTS;
+    auto v = [&](int i) { return static_cast<int>(std::lround(p[i])); };
+    for (int type = 0; type < 5; type++) {
+        w.pieceValue[type][Eval::MG] = v(P_MG_VAL + type);
+        w.pieceValue[type][Eval::EG] = v(P_EG_VAL + type);
+    }
+    for (int type = 0; type < 6; type++) {
+        for (int sq = 0; sq < 64; sq++) {
+            w.pst[type][sq][Eval::MG] = v(P_MG_PST + type * 64 + sq);
+            w.pst[type][sq][Eval::EG] = v(P_EG_PST + type * 64 + sq);
+        }
+    }
+    w.doubledPawn[Eval::MG]  = w.doubledPawn[Eval::EG]  = v(P_DOUBLED);
+    w.isolatedPawn[Eval::MG] = w.isolatedPawn[Eval::EG] = v(P_ISOLATED);
+    w.backwardPawn[Eval::MG] = w.backwardPawn[Eval::EG] = v(P_BACKWARD);
+    for (int i = 0; i < 8; i++) {
+        w.passedPawn[i][Eval::MG] = v(P_PASSED + i) / 2;
+        w.passedPawn[i][Eval::EG] = v(P_PASSED + i);
+    }
+    w.mobility[Eval::MG]   = v(P_MOBILITY_MG);
+    w.mobility[Eval::EG]   = v(P_MOBILITY_EG);
+    w.bishopPair[Eval::MG] = v(P_BISHOP_PAIR_MG);
+    w.bishopPair[Eval::EG] = v(P_BISHOP_PAIR_EG);
+    Eval::buildPsqTable(w);
+    return w;
+}
+
+void writeTable(std::ostream& out, const char* name, const std::vector<double>& p, int offset) {
+    out << "static constexpr int " << name << "[64] = {\n";
+    for (int row = 0; row < 8; row++) {
+        out << "   ";
+        for (int col = 0; col < 8; col++) {
+            char buf[16];
+            std::snprintf(buf, sizeof(buf), " %4ld,", std::lround(p[offset + row * 8 + col]));
+            out << buf;
+        }
+        out << "\n";
+    }
+    out << "};\n\n";
+}
+
+// Same layout and names as the top of Evaluation.h, ready to paste over it
+void writeWeights(std::ostream& out, const std::vector<double>& p) {
+    auto v = [&](int i) { return std::lround(p[i]); };
+    const char* typeNames[6] = { "PAWN", "ROOK", "KNIGHT", "BISHOP", "QUEEN", "KING" };
+    const int valueOrder[5] = { 0, 2, 3, 1, 4 };  // pawn, knight, bishop, rook, queen
+
+    out << "// Material values (Texel-tuned from PeSTO)\n";
+    for (const char* phase : { "MG", "EG" }) {
+        int base = phase[0] == 'M' ? P_MG_VAL : P_EG_VAL;
+        for (int type : valueOrder) {
+            char buf[96];
+            std::snprintf(buf, sizeof(buf), "static constexpr int %s_%s_VAL%*s= %3ld;\n",
+                          phase, typeNames[type], 7 - (int)std::strlen(typeNames[type]), "", v(base + type));
+            out << buf;
+        }
+        out << "\n";
+    }
+
+    out << "// Game phase weights for tapered eval (total starting phase = 24)\n"
+        << "static constexpr int KNIGHT_PHASE = 1;\n"
+        << "static constexpr int BISHOP_PHASE = 1;\n"
+        << "static constexpr int ROOK_PHASE   = 2;\n"
+        << "static constexpr int QUEEN_PHASE  = 4;\n"
+        << "static constexpr int TOTAL_PHASE  = 24; // 4*1 + 4*1 + 4*2 + 2*4\n\n"
+        << "// PeSTO Piece-Square Tables\n"
+        << "// Indexed [square], where square 0 = a1, 1 = b1, ..., 63 = h8\n\n";
+
+    const int tableOrder[6] = { 0, 2, 3, 1, 4, 5 };  // pawn, knight, bishop, rook, queen, king
+    out << "// Middlegame tables\n";
+    for (int type : tableOrder) {
+        writeTable(out, ("MG_" + std::string(typeNames[type]) + "_TABLE").c_str(), p, P_MG_PST + type * 64);
+    }
+    out << "// Endgame tables\n";
+    for (int type : tableOrder) {
+        writeTable(out, ("EG_" + std::string(typeNames[type]) + "_TABLE").c_str(), p, P_EG_PST + type * 64);
+    }
+
+    out << "// Pawn structure bonuses/penalties\n"
+        << "static constexpr int DOUBLED_PAWN_PENALTY   = " << v(P_DOUBLED) << ";\n"
+        << "static constexpr int ISOLATED_PAWN_PENALTY  = " << v(P_ISOLATED) << ";\n"
+        << "static constexpr int BACKWARD_PAWN_PENALTY  = " << v(P_BACKWARD) << ";\n"
+        << "static constexpr int PASSED_PAWN_BONUS[8]   = { ";
+    for (int i = 0; i < 8; i++) out << v(P_PASSED + i) << (i < 7 ? ", " : " };\n");
+    out << "// Index by rank distance from promotion: rank 0 or 7 are promo ranks\n\n"
+        << "// Mobility weight\n"
+        << "static constexpr int MOBILITY_MG = " << v(P_MOBILITY_MG) << ";\n"
+        << "static constexpr int MOBILITY_EG = " << v(P_MOBILITY_EG) << ";\n\n"
+        << "// Bishop pair bonus\n"
+        << "static constexpr int BISHOP_PAIR_MG = " << v(P_BISHOP_PAIR_MG) << ";\n"
+        << "static constexpr int BISHOP_PAIR_EG = " << v(P_BISHOP_PAIR_EG) << ";\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <positions> [--iterations n] [--lr x] [--out file] [--bin file] [--threads n]\n";
+        return 1;
+    }
+
+    std::string inputPath = argv[1];
+    std::string outPath = "tuned_weights.h";
+    std::string binPath;
+    int iterations = 2000;
+    double learningRate = 1.0;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--iterations")   iterations = std::stoi(argv[i + 1]);
+        else if (arg == "--lr")      learningRate = std::stod(argv[i + 1]);
+        else if (arg == "--out")     outPath = argv[i + 1];
+        else if (arg == "--bin")     binPath = argv[i + 1];
+        else if (arg == "--threads") omp_set_num_threads(std::stoi(argv[i + 1]));
+        else {
+            std::cerr << "Error: Unknown argument '" << arg << "'\n";
+            return 1;
+        }
+    }
+
+    Dataset data;
+    if (!loadDataset(inputPath, data)) {
+        std::cerr << "Error: no positions loaded from '" << inputPath << "'\n";
+        return 1;
+    }
+    std::cout << data.entries.size() << " positions, "
+              << (data.entries.size() * sizeof(TuneEntry) + data.pieces.size() * sizeof(uint16_t)) / (1024 * 1024)
+              << " MB, " << omp_get_max_threads() << " threads" << std::endl;
+
+    std::vector<double> params = initialParams();
+    double k = fitK(data, params);
+    std::cout << "K = " << k << ", initial error " << meanError(data, params, k) << std::endl;
+
+    // Adam over the full batch
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    std::vector<double> grad(NUM_PARAMS), m(NUM_PARAMS, 0.0), v(NUM_PARAMS, 0.0);
+    for (int iter = 1; iter <= iterations; iter++) {
+        computeGradient(data, params, k, grad);
+        for (int j = 0; j < NUM_PARAMS; j++) {
+            m[j] = beta1 * m[j] + (1 - beta1) * grad[j];
+            v[j] = beta2 * v[j] + (1 - beta2) * grad[j] * grad[j];
+            double mHat = m[j] / (1 - std::pow(beta1, iter));
+            double vHat = v[j] / (1 - std::pow(beta2, iter));
+            params[j] -= learningRate * mHat / (std::sqrt(vHat) + epsilon);
+        }
+        if (iter % 100 == 0 || iter == iterations) {
+            std::cout << "Iteration " << iter << ": error " << meanError(data, params, k) << std::endl;
+        }
+    }
+
+    std::ofstream out(outPath);
+    writeWeights(out, params);
+    std::cout << "Wrote " << outPath << std::endl;
+    if (!binPath.empty()) {
+        if (!Eval::saveWeights(binPath, toWeights(params))) {
+            std::cerr << "Error: cannot write '" << binPath << "'\n";
+            return 1;
+        }
+        std::cout << "Wrote " << binPath << std::endl;
+    }
+    return 0;
+}